@@ -10,7 +10,10 @@
 #include <unordered_map>
 #include <chrono>
 #include <algorithm>
+#include <optional>
+#include <memory>
 #include <sstream>
+#include <random>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -67,19 +70,28 @@ void crearTableroDesdeVector(int n, float startX, float startY,
     }
 }
 
-bool isSolvable(const std::vector<int>& board, int n)
+// Paridad de las inversiones en O(N): las fichas (sin el hueco) forman una
+// permutación y su paridad es (fichas - ciclos) % 2. Devuelve 0 (par) o 1 (impar).
+int paridadInversiones(const std::vector<int>& board)
 {
-    int inversions = 0;
-    for (size_t i = 0; i < board.size(); ++i)
+    std::vector<int> perm;
+    for (int v : board)
+        if (v != 0) perm.push_back(v - 1);
+
+    std::vector<char> visto(perm.size(), 0);
+    int ciclos = 0;
+    for (size_t i = 0; i < perm.size(); ++i)
     {
-        if (board[i] == 0) continue;
-        for (size_t j = i + 1; j < board.size(); ++j)
-        {
-            if (board[j] == 0) continue;
-            if (board[i] > board[j])
-                ++inversions;
-        }
+        if (visto[i]) continue;
+        ++ciclos;
+        for (size_t j = i; !visto[j]; j = perm[j]) visto[j] = 1;
     }
+    return ((int)perm.size() - ciclos) % 2;
+}
+
+bool isSolvable(const std::vector<int>& board, int n)
+{
+    int inversions = paridadInversiones(board); // solo importa la paridad
 
     if (n % 2 == 1)
     {
@@ -101,6 +113,14 @@ bool isSolvable(const std::vector<int>& board, int n)
 
 
 
+// Generador compartido (std::random_shuffle está obsoleto): se siembra una sola vez con
+// random_device, la primera vez que se usa.
+std::mt19937_64& generadorAleatorio()
+{
+    static std::mt19937_64 rng(std::random_device{}());
+    return rng;
+}
+
 std::vector<int> generarDisposicionAleatoria(int n)
 {
     std::vector<int> numeros;
@@ -108,10 +128,22 @@ std::vector<int> generarDisposicionAleatoria(int n)
         numeros.push_back(i);
 
     numeros.push_back(0); // Espacio vacío
+    const std::vector<int> objetivo = numeros;
+
+    // Se vuelve a barajar si sale el tablero ya ordenado ("Orden aleatorio" nunca lo devuelve)
+    do
+    {
+        std::shuffle(numeros.begin(), numeros.end(), generadorAleatorio());
 
-    do {
-        std::random_shuffle(numeros.begin(), numeros.end());
-    } while (!isSolvable(numeros, n)); // Repetir hasta que sea solvable
+        // Si no es solvable, intercambiar dos fichas (no el hueco) invierte la paridad:
+        // queda solvable sin volver a barajar.
+        if (!isSolvable(numeros, n))
+        {
+            int a = (numeros[0] == 0) ? 1 : 0;
+            int b = (numeros[a + 1] == 0) ? a + 2 : a + 1;
+            std::swap(numeros[a], numeros[b]);
+        }
+    } while (numeros == objetivo);
 
     return numeros;
 }
@@ -128,103 +160,239 @@ std::string estadoTableroAString(const std::vector<int>& numeros)
     return estado;
 }
 
-/* ---------------------- BFS (cola FIFO) que devuelve la secuencia de estados ---------------------- */
+/* ---------------------- Reproducción de la solución ---------------------- */
+
+/*
+  La solución se guarda como secuencia de movimientos del hueco ('U','D','L','R'),
+  no como un tablero por paso: en cada tic de la animación se aplica el siguiente
+  movimiento al tablero actual. Memoria O(n*n) sin importar el largo de la solución.
+*/
+struct ReproduccionSolucion {
+    std::string movimientos; // un char por paso
+    size_t siguiente = 0;    // índice del próximo movimiento a aplicar
 
-pair<bool, vector<string>> bfsSolve(const vector<int>& start, int n, size_t maxNodes = 600000, int timeLimitSeconds = 30) 
+    bool terminada() const { return siguiente >= movimientos.size(); }
+};
+
+// Mueve el hueco una casilla en la dirección dada. Devuelve false si se sale del tablero.
+bool aplicarMovimiento(std::vector<int>& numeros, int n, char mov)
 {
-    vector<string> emptyRes;
-    if (n > 3) return { false, emptyRes };
+    int pos0 = std::find(numeros.begin(), numeros.end(), 0) - numeros.begin();
+    int fila = pos0 / n;
+    int col = pos0 % n;
+
+    if (mov == 'U') fila--;
+    else if (mov == 'D') fila++;
+    else if (mov == 'L') col--;
+    else if (mov == 'R') col++;
+    else return false;
+
+    if (fila < 0 || fila >= n || col < 0 || col >= n) return false;
+    std::swap(numeros[pos0], numeros[fila * n + col]);
+    return true;
+}
+
+/* ---------------------- Presupuesto de memoria ---------------------- */
+
+// Lo que se agota es la RAM: se cuentan los bytes de cada nodo de las tablas hash,
+// el texto de las claves que no cabe en el SSO del string y los tableros en la cola.
+const size_t SSO_CAPACIDAD = 15;        // caracteres que un std::string guarda sin pedir heap
+const size_t CABECERA_MALLOC = 16;      // bytes extra por cada bloque pedido al heap
+
+size_t bytesHeapString(const string& s) {
+    return s.capacity() > SSO_CAPACIDAD ? s.capacity() + 1 + CABECERA_MALLOC : 0;
+}
+
+size_t bytesNodoHash(size_t contenido) {
+    return sizeof(void*) + sizeof(size_t) + contenido + CABECERA_MALLOC;
+}
 
-    int N = n * n;
-    vector<int> goalVec(N);
-    for (int i = 0; i < N - 1; ++i) goalVec[i] = i + 1;
-    goalVec[N - 1] = 0;
+template <class Tabla>
+size_t bytesCubetas(const Tabla& t) {
+    return t.bucket_count() * sizeof(void*) + CABECERA_MALLOC;
+}
+
+/* ---------------------- BFS (cola FIFO) que devuelve la secuencia de estados ---------------------- */
 
-    string goalKey = estadoTableroAString(goalVec);
-    string startKey = estadoTableroAString(start);
+// Resultado de avanzar una búsqueda un pedazo
+enum ResultadoPaso { PASO_EN_CURSO, PASO_ENCONTRADO, PASO_SIN_SOLUCION };
+
+const size_t NODOS_POR_CUADRO = 2000; // pocos ms de BFS (claves string) entre dos cuadros
+
+/*
+  BfsPorPasos: el BFS de siempre (cola + visited + parent + moveTaken) guardado en un objeto
+  que se avanza de a "presupuesto" nodos y sigue exactamente donde quedó. La ventana lo avanza
+  NODOS_POR_CUADRO por cuadro en el mismo hilo y mientras tanto muestra el frente de la cola.
+*/
+class BfsPorPasos {
+public:
+    BfsPorPasos(const vector<int>& start, int n_, size_t memoryBudgetBytes)
+        : n(n_), N(n_ * n_), limiteBytes(memoryBudgetBytes),
+          bytesTableroEnCola(sizeof(vector<int>) + n_ * n_ * sizeof(int) + CABECERA_MALLOC)
+    {
+        vector<int> goalVec(N);
+        for (int i = 0; i < N - 1; ++i) goalVec[i] = i + 1;
+        goalVec[N - 1] = 0;
+        goalKey = estadoTableroAString(goalVec);
+        startKey = estadoTableroAString(start);
+
+        if (startKey == goalKey) { estado = PASO_ENCONTRADO; return; }
+
+        // espacio completo (N!/2 tableros) reservado de entrada: sin rehash a mitad de la
+        // búsqueda, que en un solo cuadro se notaría como un tirón. Solo si entero cabe en el
+        // presupuesto (en la práctica n <= 3); si no, las tablas crecen como siempre y el tope
+        // de memoria corta la búsqueda mucho antes. El producto se deja de calcular apenas pasa
+        // el presupuesto, así no se desborda con n grandes.
+        size_t alcanzables = 1;
+        for (int i = 3; i <= N && alcanzables <= limiteBytes; ++i) alcanzables *= i;
+        if (alcanzables <= limiteBytes / (bytesEstado(startKey, startKey) + bytesTableroEnCola)) {
+            visited.reserve(alcanzables);
+            parent.reserve(alcanzables);
+            moveTaken.reserve(alcanzables);
+        }
 
-    if (startKey == goalKey) {
-        return { true, vector<string>{startKey} };
+        q.push(start);
+        visited.insert(startKey);
+        parent[startKey] = "";
+        usados += bytesEstado(startKey, "") + bytesTableroEnCola;
     }
 
+    ResultadoPaso avanzar(size_t presupuesto) {
+        static const int dr[4] = { -1, 1, 0, 0 };
+        static const int dc[4] = { 0, 0, -1, 1 };
+        static const char mc[4] = { 'U','D','L','R' };
+
+        for (; presupuesto > 0 && estado == PASO_EN_CURSO; --presupuesto) {
+            size_t cubetas = bytesCubetas(visited) + bytesCubetas(parent) + bytesCubetas(moveTaken);
+            if (q.empty() || usados + cubetas > limiteBytes) { estado = PASO_SIN_SOLUCION; break; }
+
+            vector<int> cur = move(q.front()); q.pop();
+            usados -= bytesTableroEnCola;
+            ++nodes;
+            string curKey = estadoTableroAString(cur);
+
+            int zero = -1;
+            for (int i = 0; i < N; ++i) if (cur[i] == 0) { zero = i; break; }
+            int zr = zero / n;
+            int zc = zero % n;
+
+            for (int k = 0; k < 4; ++k) {
+                int nr = zr + dr[k];
+                int nc = zc + dc[k];
+                if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
+
+                vector<int> nxt = cur;
+                swap(nxt[zero], nxt[nr * n + nc]);
+                string nxtKey = estadoTableroAString(nxt);
+
+                if (visited.find(nxtKey) != visited.end()) continue;
+                visited.insert(nxtKey);
+                parent[nxtKey] = curKey;
+                moveTaken[nxtKey] = mc[k];
+                usados += bytesEstado(nxtKey, curKey);
+
+                if (nxtKey == goalKey) {
+                    // reconstruir solo los movimientos (la raíz no tiene moveTaken)
+                    string curk = nxtKey;
+                    while (curk != startKey) {
+                        movs.push_back(moveTaken[curk]);
+                        curk = parent[curk];
+                    }
+                    reverse(movs.begin(), movs.end());
+                    estado = PASO_ENCONTRADO;
+                    break;
+                }
+
+                q.push(move(nxt));
+                usados += bytesTableroEnCola;
+            }
+        }
+        return estado;
+    }
+
+    const string& movimientos() const { return movs; }     // la solución, cuando se encontró
+    bool hayFrente() const { return !q.empty(); }
+    const vector<int>& frente() const { return q.front(); } // próximo tablero a expandir
+    size_t nodos() const { return nodes; }
+
+private:
+    int n, N;
+    size_t limiteBytes;
+    size_t bytesTableroEnCola;
+    string goalKey, startKey;
+
     queue<vector<int>> q;
     unordered_set<string> visited;
     unordered_map<string, string> parent;
     unordered_map<string, char> moveTaken;
+    size_t usados = 0; // bytes contabilizados
+    size_t nodes = 0;
+    string movs;
+    ResultadoPaso estado = PASO_EN_CURSO;
+
+    static size_t bytesEstado(const string& key, const string& padre) {
+        size_t heapKey = bytesHeapString(key);
+        return bytesNodoHash(sizeof(string)) + heapKey
+             + bytesNodoHash(2 * sizeof(string)) + heapKey + bytesHeapString(padre)
+             + bytesNodoHash(sizeof(string) + sizeof(char)) + heapKey;
+    }
+};
+
+
+
 
-    q.push(start);
-    visited.insert(startKey);
-    parent[startKey] = "";
 
-    int dr[4] = { -1, 1, 0, 0 };
-    int dc[4] = { 0, 0, -1, 1 };
-    char mc[4] = { 'U','D','L','R' };
 
-    size_t nodes = 0;
-    auto t0 = chrono::steady_clock::now();
-
-    while (!q.empty()) {
-        auto now = chrono::steady_clock::now();
-        auto elapsed = chrono::duration_cast<chrono::seconds>(now - t0).count();
-        if (elapsed > timeLimitSeconds) return { false, emptyRes };
-        if (nodes > maxNodes) return { false, emptyRes };
-
-        vector<int> cur = q.front(); q.pop();
-        ++nodes;
-        string curKey = estadoTableroAString(cur);
-
-        int zero = -1;
-        for (int i = 0; i < N; ++i) if (cur[i] == 0) { zero = i; break; }
-        int zr = zero / n;
-        int zc = zero % n;
-
-        for (int k = 0; k < 4; ++k) {
-            int nr = zr + dr[k];
-            int nc = zc + dc[k];
-            if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
-
-            vector<int> nxt = cur;
-            swap(nxt[zero], nxt[nr * n + nc]);
-            string nxtKey = estadoTableroAString(nxt);
-
-            if (visited.find(nxtKey) != visited.end()) continue;
-            visited.insert(nxtKey);
-            parent[nxtKey] = curKey;
-            moveTaken[nxtKey] = mc[k];
-
-            if (nxtKey == goalKey) {
-                vector<string> path;
-                string curk = nxtKey;
-                while (!curk.empty()) {
-                    path.push_back(curk);
-                    curk = parent[curk];
-                }
-                reverse(path.begin(), path.end());
-                return { true, path };
-            }
 
-            q.push(nxt);
-        }
-    }
 
-    return { false, emptyRes };
-}
 
 
+/* ---------------------- Planificador de redibujo ---------------------- */
 
+// Decide cuándo hace falta dibujar un cuadro y cuánto puede dormir el bucle principal.
+// Se redibuja solo si algo cambió (evento, paso de la animación, reloj de TGUI), nunca a
+// más de un cuadro cada MS_POR_CUADRO, y sin cambios el hilo duerme en waitEvent en vez
+// de ocupar un núcleo. Con una búsqueda en curso se duerme a lo sumo hasta el próximo
+// cuadro: cada vuelta del bucle avanza un pedazo de la búsqueda.
+struct PlanificadorRedibujo {
+    static const int MS_POR_CUADRO = 16;       // tope de ~60 cuadros por segundo
+    static const int MS_POR_MOVIMIENTO = 300;  // un movimiento de la solución cada 300 ms
+    static const int MS_INACTIVO = 500;        // despertar de vez en cuando (cursor de TGUI)
 
+    bool pendiente = true; // hay que dibujar (el primer cuadro siempre)
+    sf::Clock relojCuadro;
+    sf::Clock relojAnimacion;
 
+    void marcar() { pendiente = true; }
 
+    bool tocaMovimiento() const { return relojAnimacion.getElapsedTime().asMilliseconds() >= MS_POR_MOVIMIENTO; }
 
+    // true si hay que dibujar ahora (y lo da por dibujado)
+    bool tocaDibujar() {
+        if (!pendiente || relojCuadro.getElapsedTime().asMilliseconds() < MS_POR_CUADRO) return false;
+        pendiente = false;
+        relojCuadro.restart();
+        return true;
+    }
 
+    // cuánto esperar en waitEvent: hasta el próximo cuadro, el próximo movimiento o MS_INACTIVO
+    sf::Time espera(bool animando, bool buscando) const {
+        int ms = MS_INACTIVO;
+        if (pendiente || buscando) ms = std::min(ms, MS_POR_CUADRO - (int)relojCuadro.getElapsedTime().asMilliseconds());
+        if (animando) ms = std::min(ms, MS_POR_MOVIMIENTO - (int)relojAnimacion.getElapsedTime().asMilliseconds());
+        return sf::milliseconds(std::max(ms, 1)); // 0 en waitEvent sería esperar para siempre
+    }
+};
 
 int main()
 {
 
     
-    std::vector<std::vector<int>> solucion;
-    size_t indiceSolucion = 0;
+    ReproduccionSolucion reproduccion; // movimientos pendientes de la solución
+    std::unique_ptr<BfsPorPasos> busqueda; // BFS en curso: avanza NODOS_POR_CUADRO por cuadro
+    std::vector<int> inicioBusqueda;       // tablero desde el que se busca
     bool animando = false;
+    PlanificadorRedibujo planificador;
 
     std::vector<int> numerosTablero; // Para guardar la disposición actual
     int nTablero = 0; // Tamaño actual del tablero
@@ -296,6 +464,7 @@ int main()
 
     if (n < 2 || n > 10) return;
 
+    busqueda.reset(); // el tablero cambió: la búsqueda en curso ya no sirve
     nTablero = n;
     numerosTablero.clear();
     for (int i = 1; i < n * n; ++i)
@@ -309,6 +478,7 @@ int main()
         if (nTablero == 0)
             return;
 
+        busqueda.reset();
         numerosTablero = generarDisposicionAleatoria(nTablero);
         crearTableroDesdeVector(nTablero, 100, 200, numerosTablero, tablero, etiquetas, gui);
 
@@ -325,6 +495,7 @@ int main()
     if (nTablero == 0)
         return;
 
+    busqueda.reset();
     numerosTablero.clear();
     for (int i = 1; i < nTablero * nTablero; ++i)
         numerosTablero.push_back(i);
@@ -339,26 +510,17 @@ int main()
 
     botonResolver->onClick([&]() {
     if (nTablero == 0) return;
-
-    auto result = bfsSolve(numerosTablero, nTablero);
-    if (!result.first) {
+    if (nTablero > 3) {
         std::cout << "No se encontró solución (o n > 3)." << std::endl;
         return;
     }
-    std::cout << "Solución encontrada en " << result.second.size() - 1 << " movimientos." << std::endl;
-
-     solucion.clear();
-    for (auto& key : result.second) {
-        std::vector<int> estado;
-        std::stringstream ss(key);
-        std::string token;
-        while (std::getline(ss, token, ',')) {
-            estado.push_back(std::stoi(token));
-        }
-        solucion.push_back(estado);
-    }
-    indiceSolucion = 0;
-    animando = true;
+
+    // la búsqueda avanza de a pedazos en el bucle principal (la ventana sigue respondiendo)
+    busqueda = std::make_unique<BfsPorPasos>(numerosTablero, nTablero, (size_t)256 << 20);
+    inicioBusqueda = numerosTablero;
+    animando = false;
+    planificador.marcar();
+    std::cout << "Buscando solución..." << std::endl;
 
 
 
@@ -370,23 +532,47 @@ int main()
     
     while (window.isOpen())
     {
+        // dormir hasta el próximo evento, movimiento de la animación o cuadro pendiente
+        std::optional<sf::Event> primero = window.waitEvent(planificador.espera(animando, busqueda != nullptr));
+
+        // un pedazo del BFS por vuelta; mientras tanto se muestra el frente de la cola
+        if (busqueda) {
+            ResultadoPaso r = busqueda->avanzar(NODOS_POR_CUADRO);
+            const std::vector<int>& vista = (r == PASO_EN_CURSO && busqueda->hayFrente()) ? busqueda->frente() : inicioBusqueda;
+            crearTableroDesdeVector(nTablero, 100, 200, vista, tablero, etiquetas, gui);
+            planificador.marcar();
+
+            if (r == PASO_ENCONTRADO) {
+                std::cout << "Solución encontrada en " << busqueda->movimientos().size() << " movimientos." << std::endl;
+                reproduccion.movimientos = busqueda->movimientos();
+                reproduccion.siguiente = 0;
+                animando = true;
+                planificador.relojAnimacion.restart();
+            }
+            else if (r == PASO_SIN_SOLUCION) {
+                std::cout << "No se encontró solución (o n > 3)." << std::endl;
+            }
+            if (r != PASO_EN_CURSO) busqueda.reset();
+        }
 
-        static sf::Clock relojAnim;
-        if (animando && indiceSolucion < solucion.size()) {
-            if (relojAnim.getElapsedTime().asMilliseconds() > 300) {
-                numerosTablero = solucion[indiceSolucion];
+        if (animando && !reproduccion.terminada()) {
+            if (planificador.tocaMovimiento()) {
+                // aplicar solo el siguiente movimiento sobre el tablero actual
+                aplicarMovimiento(numerosTablero, nTablero, reproduccion.movimientos[reproduccion.siguiente]);
                 crearTableroDesdeVector(nTablero, 100, 200, numerosTablero, tablero, etiquetas, gui);
-                indiceSolucion++;
-                relojAnim.restart();
-            }
-            if (indiceSolucion >= solucion.size()) {
-                animando = false; // terminó la animación
+                reproduccion.siguiente++;
+                planificador.relojAnimacion.restart();
+                planificador.marcar();
             }
         }
+        if (animando && reproduccion.terminada()) {
+            animando = false; // terminó la animación
+        }
 
-        while (auto event = window.pollEvent())
+        // el evento que despertó al bucle y los que estén en cola
+        for (auto event = std::move(primero); event; event = window.pollEvent())
         {
-
+            planificador.marcar(); // cualquier evento puede cambiar la GUI (hover, texto, clic)
             gui.handleEvent(*event);
 
             if (event->is<sf::Event::Closed>())
@@ -400,6 +586,10 @@ int main()
             // Si no hay tablero aún, ignorar
             if (nTablero == 0)
                 continue;
+            if (busqueda) { // mover una ficha cancela la búsqueda: se vuelve al tablero de partida
+                busqueda.reset();
+                crearTableroDesdeVector(nTablero, 100, 200, numerosTablero, tablero, etiquetas, gui);
+            }
 
             const auto& keyEvent = event->getIf<sf::Event::KeyPressed>();
             if (!keyEvent) continue;
@@ -436,6 +626,10 @@ int main()
 
  
         }
+
+        if (gui.updateTime()) planificador.marcar(); // animaciones y cursor de TGUI
+        if (!planificador.tocaDibujar()) continue;
+
         window.clear(sf::Color(60, 60, 60));
 
 
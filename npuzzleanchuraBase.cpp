@@ -1,12 +1,14 @@
 ﻿/*
   sliding_puzzle_vscode.cpp
-  Programa de consola en C++ para Windows (pensado para ejecutarse en Visual Studio Code).
+  Programa de consola en C++ para Windows y terminales Linux (pensado para ejecutarse en Visual Studio Code).
   - Pide tamaño n por teclado.
   - Genera tablero aleatorio solvable n x n.
   - Muestra tablero bonito en "cajitas".
   - Menú:
       1) Resolver con BFS (cola FIFO) -> muestra tableros intermedios (solo para n=2 ó n=3).
       2) Jugar manualmente -> mover hueco con flechas; 'S' para salir al prompt de tamaño.
+      3) Resolver con BFS de frontera (solo dos capas en memoria, camino por divide y vencerás).
+      4) Resolver con BFS ordenando capas (detección de duplicados diferida, sin tabla hash).
   Comentarios en español, paso a paso.
 */
 
@@ -20,346 +22,3581 @@
 #include <random>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <array>
+#include <set>
+#include <list>
+#include <memory>
 #include <sstream>
 #include <iomanip>
+#include <functional>
+#include <climits>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
+#ifdef _WIN32
 #include <conio.h>    // _getch en Windows
-#include <windows.h>  // para colores y Sleep
+#include <windows.h>  // consola y archivos mapeados
+#include <io.h>       // _commit
+#else
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap
+#include <sys/stat.h>
+#include <unistd.h>
+#include <termios.h>   // modo crudo del teclado
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h> // contadores de hardware (--bench)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 using namespace std;
 
-/* ---------------------- Utilidades de consola (colores) ---------------------- */
+/* ---------------------- Terminal portable (ANSI + teclado en modo crudo) ---------------------- */
 
-// Cambia el color de texto en la consola de Windows.
-// Puedes pasar atributos como 7 (gris claro/default), 9 (azul), 10 (verde), 11 (cian), 12 (rojo), 13 (magenta), 14 (amarillo)
-void setColor(int attr) {
+/*
+  Todo lo que se dibuja se arma primero en un string (un "cuadro") con secuencias ANSI
+  para colores y limpiar pantalla, y se escribe con una sola llamada al sistema
+  (escribirTerminal). Así mostrar soluciones largas no hace una escritura por casilla,
+  y funciona igual en Linux, por ssh y en la consola de Windows 10+ (con VT activado).
+*/
+const char* const ANSI_RESET = "\x1b[0m";
+const char* const ANSI_LIMPIAR = "\x1b[2J\x1b[H"; // borrar pantalla y cursor arriba a la izquierda
+
+// Teclas especiales que devuelve leerTecla (fuera del rango de un char)
+enum TeclaEspecial { TECLA_ARRIBA = 1000, TECLA_ABAJO, TECLA_IZQUIERDA, TECLA_DERECHA };
+
+// Color ANSI de primer plano para los atributos de la consola de Windows que se usaban antes:
+// 7 (gris claro/default), 8 (gris oscuro), 9 (azul), 10 (verde), 11 (cian), 12 (rojo), 13 (magenta), 14 (amarillo), 15 (blanco)
+string colorAnsi(int attr) {
+    static const int codigos[16] = { 30, 34, 32, 36, 31, 35, 33, 37, 90, 94, 92, 96, 91, 95, 93, 97 };
+    if (attr == 7) return ANSI_RESET;
+    return "\x1b[" + to_string(codigos[attr & 15]) + "m";
+}
+
+// Escribe el cuadro completo de una vez (vacía antes lo que haya quedado en cout)
+void escribirTerminal(const string& cuadro) {
+    cout << flush;
+#ifdef _WIN32
+    static bool vtActivado = false;
     HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hConsole, (WORD)attr);
+    if (!vtActivado) { // que la consola interprete las secuencias ANSI
+        DWORD modo = 0;
+        if (GetConsoleMode(hConsole, &modo)) SetConsoleMode(hConsole, modo | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        vtActivado = true;
+    }
+    DWORD escritos;
+    WriteFile(hConsole, cuadro.data(), (DWORD)cuadro.size(), &escritos, NULL);
+#else
+    size_t hecho = 0;
+    while (hecho < cuadro.size()) { // write puede escribir menos de lo pedido
+        ssize_t r = write(STDOUT_FILENO, cuadro.data() + hecho, cuadro.size() - hecho);
+        if (r <= 0) break;
+        hecho += (size_t)r;
+    }
+#endif
+}
+
+void limpiarPantalla() { escribirTerminal(ANSI_LIMPIAR); }
+
+#ifndef _WIN32
+// Pone el teclado en modo crudo (sin eco ni espera de Enter) mientras vive el objeto
+struct ModoCrudo {
+    termios original;
+    bool activo;
+    ModoCrudo() {
+        activo = tcgetattr(STDIN_FILENO, &original) == 0;
+        if (!activo) return; // stdin no es una terminal
+        termios crudo = original;
+        crudo.c_lflag &= ~(ICANON | ECHO);
+        crudo.c_cc[VMIN] = 1;
+        crudo.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &crudo);
+    }
+    ~ModoCrudo() { if (activo) tcsetattr(STDIN_FILENO, TCSANOW, &original); }
+};
+#endif
+
+/*
+  Lee una tecla sin esperar Enter. Devuelve el carácter, una TeclaEspecial para las flechas
+  o -1 si se terminó la entrada.
+   - Windows: _getch (las flechas llegan como 224 + código).
+   - Linux: modo crudo; las flechas llegan como ESC [ A/B/C/D.
+*/
+int leerTecla() {
+#ifdef _WIN32
+    int ch = _getch();
+    if (ch == 224 || ch == 0) {
+        int ch2 = _getch();
+        if (ch2 == 72) return TECLA_ARRIBA;
+        if (ch2 == 80) return TECLA_ABAJO;
+        if (ch2 == 75) return TECLA_IZQUIERDA;
+        if (ch2 == 77) return TECLA_DERECHA;
+        return ch2;
+    }
+    return ch;
+#else
+    ModoCrudo modo;
+    unsigned char c;
+    if (read(STDIN_FILENO, &c, 1) != 1) return -1;
+    if (c != 0x1b) return c;
+    unsigned char sec[2];
+    if (read(STDIN_FILENO, &sec[0], 1) != 1 || sec[0] != '[') return 0x1b;
+    if (read(STDIN_FILENO, &sec[1], 1) != 1) return 0x1b;
+    switch (sec[1]) {
+    case 'A': return TECLA_ARRIBA;
+    case 'B': return TECLA_ABAJO;
+    case 'C': return TECLA_DERECHA;
+    case 'D': return TECLA_IZQUIERDA;
+    default: return 0x1b;
+    }
+#endif
 }
 
 /* ---------------------- Funciones para representar y mostrar el tablero ---------------------- */
 
 /*
-  Imprime el tablero (representado en vector<int> de longitud n*n) de forma
-  alineada en "cajitas" para que sea más legible.
+  Dibuja el tablero (representado en vector<int> de longitud n*n) de forma
+  alineada en "cajitas" para que sea más legible, en un string con colores ANSI.
   - 0 representa el hueco.
   - n es la dimensión (anchura/alto).
 */
-void printBoard(const vector<int>& board, int n) {
-    //system("cls"); // limpia la pantalla en Windows
-
+string dibujarTablero(const vector<int>& board, int n) {
     int N = n * n;
     // calcular ancho para cada número (número más grande = N-1)
     int maxNum = N - 1;
     int width = to_string(maxNum).size();
 
-    cout << "\n";
+    string cuadro = "\n";
     for (int r = 0; r < n; ++r) {
-        cout << "   "; // margen izquierdo
+        cuadro += "   "; // margen izquierdo
         for (int c = 0; c < n; ++c) {
             int val = board[r * n + c];
             // Elegimos un color simple por tile (solo foreground, para evitar problemas)
             if (val == 0) {
-                setColor(8); // gris oscuro para el hueco
+                cuadro += colorAnsi(8); // gris oscuro para el hueco
             }
             else {
                 // paleta simple (repetitiva)
                 int pal[7] = { 9, 10, 11, 12, 13, 14, 15 };
-                int idx = val % 7;
-                setColor(pal[idx]);
+                cuadro += colorAnsi(pal[val % 7]);
             }
 
-            // imprimir la "cajita" con espacios para alinear según width
-            cout << "[";
+            // la "cajita" con espacios para alinear según width
+            cuadro += "[";
             if (val == 0) {
-                for (int k = 0; k < width; ++k) cout << " ";
+                cuadro.append(width, ' ');
             }
             else {
                 // centrar el número dentro del ancho
                 string s = to_string(val);
                 int leftPad = (width - (int)s.size()) / 2;
                 int rightPad = width - (int)s.size() - leftPad;
-                for (int k = 0; k < leftPad; ++k) cout << " ";
-                cout << s;
-                for (int k = 0; k < rightPad; ++k) cout << " ";
+                cuadro.append(leftPad, ' ');
+                cuadro += s;
+                cuadro.append(rightPad, ' ');
+            }
+            cuadro += "] ";
+            cuadro += ANSI_RESET;
+        }
+        cuadro += "\n\n";
+    }
+    return cuadro;
+}
+
+// Muestra el tablero con una sola escritura
+void printBoard(const vector<int>& board, int n) {
+    escribirTerminal(dibujarTablero(board, n));
+}
+
+/* ---------------------- Utilidades de estado y solubilidad ---------------------- */
+
+/*
+  Convierte el tablero (vector<int>) a string (clave) para usar en visited/parent.
+  Formato: números separados por comas, ej: "1,2,3,0,4"
+*/
+string boardToKey(const vector<int>& b) {
+    ostringstream oss;
+    for (size_t i = 0; i < b.size(); ++i) {
+        if (i) oss << ',';
+        oss << b[i];
+    }
+    return oss.str();
+}
+
+/*
+  Convierte clave a tablero (vector<int>).
+*/
+vector<int> keyToBoard(const string& key) {
+    vector<int> b;
+    stringstream ss(key);
+    string token;
+    while (getline(ss, token, ',')) {
+        b.push_back(stoi(token));
+    }
+    return b;
+}
+
+/*
+  Cuenta inversiones (pares i<j con board[i] > board[j], ignorando el hueco)
+  con un árbol de Fenwick: O(N log N) en vez del doble bucle O(N^2).
+  Se recorre de derecha a izquierda y, para cada ficha, se pregunta cuántas
+  fichas menores ya aparecieron a su derecha.
+*/
+long long contarInversiones(const vector<int>& board) {
+    int N = (int)board.size();
+    vector<int> fenwick(N + 1, 0); // índices 1..N (valores 1..N-1)
+    long long inv = 0;
+    for (int i = N - 1; i >= 0; --i) {
+        int v = board[i];
+        if (v == 0) continue;
+        for (int j = v - 1; j > 0; j -= j & -j) inv += fenwick[j]; // cuántos < v
+        for (int j = v; j <= N; j += j & -j) fenwick[j]++;
+    }
+    return inv;
+}
+
+/*
+  Paridad de las inversiones en O(N) por descomposición en ciclos:
+  la secuencia de fichas (sin el hueco) es una permutación de 1..N-1, y su
+  paridad es (cantidad_de_fichas - cantidad_de_ciclos) % 2.
+  Devuelve 0 si el número de inversiones es par y 1 si es impar.
+*/
+int paridadInversiones(const vector<int>& board) {
+    int N = (int)board.size();
+    vector<int> perm;          // perm[k] = (ficha en la k-ésima casilla no vacía) - 1
+    perm.reserve(N);
+    for (int v : board) if (v != 0) perm.push_back(v - 1);
+
+    int M = (int)perm.size();
+    vector<char> visto(M, 0);
+    int ciclos = 0;
+    for (int i = 0; i < M; ++i) {
+        if (visto[i]) continue;
+        ++ciclos;
+        for (int j = i; !visto[j]; j = perm[j]) visto[j] = 1;
+    }
+    return (M - ciclos) % 2;
+}
+
+/*
+  Determina solvabilidad a partir de la paridad de inversiones.
+  Regla:
+   - Si n es impar: solvable si inversions es par.
+   - Si n es par: solvable si (inversions + fila_del_hueco_desde_abajo) % 2 == 1
+     (fila desde abajo: 1 = última fila, 2 = penúltima, ...).
+  Usa paridadInversiones (O(N)), así que sirve para tableros de miles de fichas.
+*/
+bool isSolvable(const vector<int>& board, int n) {
+    int N = n * n;
+    int par = paridadInversiones(board);
+    if (n % 2 == 1) {
+        return (par == 0);
+    }
+    else {
+        int zeroIndex = -1;
+        for (int i = 0; i < N; ++i) if (board[i] == 0) { zeroIndex = i; break; }
+        int rowFromTop = zeroIndex / n;         // 0-based
+        int rowFromBottom = n - rowFromTop;     // 1-based
+        // condición conocida para tablero de anchura par
+        return ((par + rowFromBottom) % 2 == 1);
+    }
+}
+
+/*
+  Suma de distancias Manhattan de cada ficha a su casilla objetivo (1..N-1,0).
+  Nunca sobreestima, así que IDA* encuentra la solución óptima.
+*/
+int manhattan(const vector<int>& b, int n) {
+    int h = 0;
+    for (int i = 0; i < n * n; ++i) {
+        if (b[i] == 0) continue;
+        int objetivo = b[i] - 1;
+        h += abs(i / n - objetivo / n) + abs(i % n - objetivo % n);
+    }
+    return h;
+}
+
+/* ---------------------- Generador de tableros reproducible ---------------------- */
+
+/*
+  GeneradorTableros:
+   - semilla explícita: la misma semilla produce la misma secuencia de tableros
+     (la usan --bench y --generar, que arma peticiones para pruebas de carga del servicio).
+   - aleatorio(n): baraja 0..N-1 una sola vez; si la paridad no es la solvable
+     intercambia dos fichas (nunca el hueco), lo que invierte la paridad de las
+     inversiones. Solvable por construcción, sin reintentos.
+   - caminata(n, pasos): parte del objetivo y mueve el hueco 'pasos' veces sin
+     deshacer el movimiento anterior.
+   - conDistancia(n, d): para n <= 3 devuelve un tablero a distancia óptima exacta d
+     (capa d de un BFS desde el objetivo). Para n > 3 hace caminatas de d pasos y se
+     queda con la de mayor manhattan (estimación de dureza, cota inferior de la óptima).
+     En distanciaObtenida devuelve la distancia exacta (n <= 3) o la estimación (n > 3).
+*/
+class GeneradorTableros {
+public:
+    explicit GeneradorTableros(uint64_t semilla) : rng(semilla) {}
+
+    vector<int> aleatorio(int n) {
+        int N = n * n;
+        vector<int> board(N);
+        for (int i = 0; i < N; ++i) board[i] = i;
+        do {
+            shuffle(board.begin(), board.end(), rng);
+            if (!isSolvable(board, n)) {
+                // las dos primeras casillas que no son el hueco
+                int a = (board[0] == 0) ? 1 : 0;
+                int b = (board[a + 1] == 0) ? a + 2 : a + 1;
+                swap(board[a], board[b]);
+            }
+        } while (esObjetivo(board)); // evitar estado resuelto inicial
+        return board;
+    }
+
+    vector<int> caminata(int n, int pasos) {
+        int N = n * n;
+        vector<int> board = objetivo(n);
+        int zero = N - 1;
+        int dr[4] = { -1, 1, 0, 0 };
+        int dc[4] = { 0, 0, -1, 1 };
+        int prevK = -1;
+        for (int p = 0; p < pasos; ++p) {
+            int opciones[4], total = 0;
+            for (int k = 0; k < 4; ++k) {
+                if (prevK >= 0 && (k ^ 1) == prevK) continue; // no deshacer
+                int nr = zero / n + dr[k], nc = zero % n + dc[k];
+                if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
+                opciones[total++] = k;
+            }
+            int k = opciones[uniform_int_distribution<int>(0, total - 1)(rng)];
+            int nz = (zero / n + dr[k]) * n + (zero % n + dc[k]);
+            swap(board[zero], board[nz]);
+            zero = nz;
+            prevK = k;
+        }
+        return board;
+    }
+
+    vector<int> conDistancia(int n, int distancia, int* distanciaObtenida = nullptr) {
+        if (n > 3) {
+            vector<int> mejor;
+            int mejorH = -1;
+            for (int intento = 0; intento < 32; ++intento) {
+                vector<int> b = caminata(n, distancia);
+                int h = manhattan(b, n);
+                if (h > mejorH) { mejorH = h; mejor = b; }
+            }
+            if (distanciaObtenida) *distanciaObtenida = mejorH;
+            return mejor;
+        }
+
+        // BFS por capas desde el objetivo hasta la capa "distancia" (o la última que exista)
+        int dr[4] = { -1, 1, 0, 0 };
+        int dc[4] = { 0, 0, -1, 1 };
+        vector<vector<int>> capa{ objetivo(n) };
+        unordered_set<string> visited{ boardToKey(capa[0]) };
+        int d = 0;
+        while (d < distancia) {
+            vector<vector<int>> siguiente;
+            for (auto& cur : capa) {
+                int zero = int(find(cur.begin(), cur.end(), 0) - cur.begin());
+                for (int k = 0; k < 4; ++k) {
+                    int nr = zero / n + dr[k], nc = zero % n + dc[k];
+                    if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
+                    vector<int> nxt = cur;
+                    swap(nxt[zero], nxt[nr * n + nc]);
+                    if (visited.insert(boardToKey(nxt)).second) siguiente.push_back(move(nxt));
+                }
+            }
+            if (siguiente.empty()) break; // no hay estados más lejanos
+            capa.swap(siguiente);
+            ++d;
+        }
+        if (distanciaObtenida) *distanciaObtenida = d;
+        return capa[uniform_int_distribution<size_t>(0, capa.size() - 1)(rng)];
+    }
+
+private:
+    mt19937_64 rng;
+
+    static vector<int> objetivo(int n) {
+        int N = n * n;
+        vector<int> goal(N);
+        for (int i = 0; i < N - 1; ++i) goal[i] = i + 1;
+        goal[N - 1] = 0;
+        return goal;
+    }
+
+    static bool esObjetivo(const vector<int>& b) {
+        for (size_t i = 0; i + 1 < b.size(); ++i) if (b[i] != (int)i + 1) return false;
+        return b.back() == 0;
+    }
+};
+
+/*
+  Genera un tablero aleatorio pero **solvable** (y distinto del objetivo).
+  - usa un GeneradorTableros sembrado una sola vez con el reloj.
+*/
+vector<int> generateSolvableBoard(int n) {
+    // semilla tomada del reloj UNA sola vez (antes se re-sembraba en cada llamada)
+    static GeneradorTableros gen((uint64_t)chrono::high_resolution_clock::now().time_since_epoch().count());
+    return gen.aleatorio(n);
+}
+
+/* ---------------------- Estado del tablero con movimientos incrementales ---------------------- */
+
+/*
+  Conflictos lineales de una fila o columna:
+   - fichas: valores de la línea en orden (0 = hueco), cuenta: n
+   - linea: índice de la fila/columna, esFila: true = fila
+   - trabajo: espacio para 2n enteros que pone quien llama (sin límite fijo de n)
+  Solo cuentan las fichas cuya casilla objetivo está en esta misma línea. Las que están en
+  orden relativo correcto forman una subsecuencia creciente; cada ficha fuera de la más larga
+  tiene que salir de la línea y volver (al menos 2 movimientos más que manhattan).
+  Devuelve cuántas fichas tienen que salir.
+*/
+int conflictosLinea(const int* fichas, int n, int linea, bool esFila, int* trabajo) {
+    int* objetivo = trabajo; // coordenada objetivo dentro de la línea
+    int* lis = trabajo + n;  // subsecuencia creciente más larga (O(n^2))
+    int cuenta = 0;
+    for (int i = 0; i < n; ++i) {
+        int v = fichas[i];
+        if (v == 0) continue;
+        int fila = (v - 1) / n, col = (v - 1) % n;
+        if ((esFila ? fila : col) == linea) objetivo[cuenta++] = esFila ? col : fila;
+    }
+    int largo = 0;
+    for (int i = 0; i < cuenta; ++i) {
+        lis[i] = 1;
+        for (int j = 0; j < i; ++j)
+            if (objetivo[j] < objetivo[i] && lis[j] + 1 > lis[i]) lis[i] = lis[j] + 1;
+        largo = max(largo, lis[i]);
+    }
+    return cuenta - largo;
+}
+
+// Valor Zobrist de (ficha, casilla): splitmix64 de la pareja, sin tabla que inicializar
+uint64_t valorZobrist(int ficha, int pos) {
+    uint64_t x = ((uint64_t)ficha << 16) | (uint64_t)pos;
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/*
+  EstadoTablero: tablero más todo lo que los resolutores derivan de él, mantenido al mover.
+   - hueco: posición del 0
+   - zobrist: XOR de valorZobrist(ficha, casilla) de todas las casillas
+   - manhattan: suma de distancias manhattan
+   - conflictos: fichas que tienen que salir de su fila/columna (conflictosLinea)
+   - clave: tablero empaquetado de a 4 bits (el mismo formato que empaquetarTablero, n <= 4)
+  applyMove/undoMove cambian una ficha de lugar y actualizan cada campo con la diferencia:
+  manhattan, zobrist y clave en O(1); los conflictos solo en las dos líneas que cambian.
+  Movimientos: 'U','D','L','R' o índice 0..3 (el inverso de k es k ^ 1).
+*/
+class EstadoTablero {
+public:
+    EstadoTablero(const vector<int>& b, int n_)
+        : celdas(b), n(n_), conflictosFila(n_), conflictosColumna(n_), auxLinea(3 * n_)
+    {
+        for (int i = 0; i < n * n; ++i) {
+            int v = celdas[i];
+            if (v == 0) hueco_ = i;
+            else manhattan_ += distanciaFicha(v, i);
+            zobrist_ ^= valorZobrist(v, i);
+            if (n <= 4) clave_ |= (uint64_t)v << (4 * i);
+        }
+        for (int l = 0; l < n; ++l) {
+            conflictosFila[l] = conflictosDe(l, true);
+            conflictosColumna[l] = conflictosDe(l, false);
+            conflictos_ += conflictosFila[l] + conflictosColumna[l];
+        }
+    }
+
+    bool applyMove(char move) {
+        int k = string("UDLR").find(move);
+        return k >= 0 && k < 4 && applyMove(k);
+    }
+
+    // mueve el hueco en la dirección k; false (sin cambios) si se sale del tablero
+    bool applyMove(int k) {
+        static const int dr[4] = { -1, 1, 0, 0 };
+        static const int dc[4] = { 0, 0, -1, 1 };
+        int nr = hueco_ / n + dr[k], nc = hueco_ % n + dc[k];
+        if (nr < 0 || nr >= n || nc < 0 || nc >= n) return false;
+
+        int desde = nr * n + nc, hacia = hueco_;
+        int v = celdas[desde];
+        celdas[hacia] = v;
+        celdas[desde] = 0;
+        hueco_ = desde;
+
+        manhattan_ += distanciaFicha(v, hacia) - distanciaFicha(v, desde);
+        zobrist_ ^= valorZobrist(v, desde) ^ valorZobrist(v, hacia) ^ valorZobrist(0, desde) ^ valorZobrist(0, hacia);
+        if (n <= 4) clave_ ^= ((uint64_t)v << (4 * desde)) ^ ((uint64_t)v << (4 * hacia));
+
+        // la ficha cambió de fila (U/D) o de columna (L/R): solo esas dos líneas cambian
+        bool vertical = k < 2;
+        vector<int>& lineas = vertical ? conflictosFila : conflictosColumna;
+        int a = vertical ? desde / n : desde % n;
+        int b = vertical ? hacia / n : hacia % n;
+        conflictos_ -= lineas[a] + lineas[b];
+        lineas[a] = conflictosDe(a, vertical);
+        lineas[b] = conflictosDe(b, vertical);
+        conflictos_ += lineas[a] + lineas[b];
+        return true;
+    }
+
+    // deshace un applyMove(k) que devolvió true
+    void undoMove(int k) { applyMove(k ^ 1); }
+
+    const vector<int>& tablero() const { return celdas; }
+    int hueco() const { return hueco_; }
+    uint64_t zobrist() const { return zobrist_; }
+    int manhattan() const { return manhattan_; }
+    int conflictos() const { return conflictos_; }
+    uint64_t clave() const { return clave_; }
+    // manhattan + conflictos lineales: no sobreestima y es más fuerte que manhattan sola
+    int heuristica() const { return manhattan_ + 2 * conflictos_; }
+
+private:
+    vector<int> celdas;
+    int n;
+    int hueco_ = 0;
+    uint64_t zobrist_ = 0;
+    int manhattan_ = 0;
+    int conflictos_ = 0;
+    uint64_t clave_ = 0;
+    vector<int> conflictosFila, conflictosColumna;
+    mutable vector<int> auxLinea; // fichas de una línea + trabajo de conflictosLinea (3n)
+
+    int distanciaFicha(int v, int pos) const {
+        return abs(pos / n - (v - 1) / n) + abs(pos % n - (v - 1) % n);
+    }
+
+    int conflictosDe(int linea, bool esFila) const {
+        int* fichas = auxLinea.data();
+        for (int i = 0; i < n; ++i) fichas[i] = esFila ? celdas[linea * n + i] : celdas[i * n + linea];
+        return conflictosLinea(fichas, n, linea, esFila, fichas + n);
+    }
+};
+
+/* ---------------------- Objetivo arbitrario (renombrar fichas) ---------------------- */
+
+/*
+  NormalizacionObjetivo: lleva un par (inicio, objetivo cualquiera) al objetivo de siempre
+  1..N-1,0 para que las tablas, heurísticas y cachés sirvan sin cambios.
+   - Si el hueco del objetivo está en una esquina, una simetría del cuadrado (giro o reflejo)
+     lo lleva a la esquina inferior derecha; después se renombran las fichas: la que el
+     objetivo pone en la casilla q pasa a llamarse q+1. Un tablero y su versión normalizada
+     necesitan exactamente los mismos movimientos (girados/reflejados), así que la solución
+     sigue siendo óptima.
+   - Si no está en una esquina, primero se lleva el hueco del objetivo a la esquina más
+     cercana con un camino fijo y al final se deshace ese camino: la solución es válida pero
+     puede tener hasta 2(n-1) movimientos de más (exacta() == false).
+  Movimientos: 'U','D','L','R' del hueco, como en EstadoTablero.
+*/
+class NormalizacionObjetivo {
+public:
+    NormalizacionObjetivo(const vector<int>& objetivo, int n_) : n(n_), etiqueta(n_ * n_) {
+        int N = n * n;
+        int hueco = int(find(objetivo.begin(), objetivo.end(), 0) - objetivo.begin());
+        int r = hueco / n, c = hueco % n;
+
+        // camino fijo del hueco hasta la esquina más cercana (primero vertical, después horizontal)
+        int er = (r < n / 2) ? 0 : n - 1, ec = (c < n / 2) ? 0 : n - 1;
+        for (; r != er; r += (er > r ? 1 : -1)) prefijo += (er > r ? 'D' : 'U');
+        for (; c != ec; c += (ec > c ? 1 : -1)) prefijo += (ec > c ? 'R' : 'L');
+        EstadoTablero g(objetivo, n);
+        for (char m : prefijo) g.applyMove(m);
+
+        // primera simetría que manda la esquina (er, ec) a (n-1, n-1)
+        for (simetria = 0; simetria < 8; ++simetria) {
+            int fr, fc;
+            transformar(er, ec, fr, fc);
+            if (fr == n - 1 && fc == n - 1) break;
+        }
+
+        // renombrar: la ficha que queda en la casilla q del objetivo transformado se llama q+1
+        vector<int> gt = transformarTablero(g.tablero());
+        for (int q = 0; q < N - 1; ++q) etiqueta[gt[q]] = q + 1;
+        etiqueta[0] = 0;
+    }
+
+    bool exacta() const { return prefijo.empty(); }
+
+    // tablero equivalente con respecto al objetivo 1..N-1,0
+    vector<int> normalizar(const vector<int>& tablero) const {
+        vector<int> t = transformarTablero(tablero);
+        for (int& v : t) v = etiqueta[v];
+        return t;
+    }
+
+    // traduce una solución del tablero normalizado a movimientos del tablero original
+    string movimientosOriginales(const string& movsNormalizados) const {
+        static const char letras[4] = { 'U', 'D', 'L', 'R' };
+        static const int dr[4] = { -1, 1, 0, 0 };
+        static const int dc[4] = { 0, 0, -1, 1 };
+        string movs;
+        for (char m : movsNormalizados) {
+            int k = int(string("UDLR").find(m));
+            // dirección inversa por la simetría (matriz ortogonal: la inversa es la transpuesta)
+            const int* M = MATRICES[simetria];
+            int odr = M[0] * dr[k] + M[2] * dc[k];
+            int odc = M[1] * dr[k] + M[3] * dc[k];
+            for (int j = 0; j < 4; ++j) if (dr[j] == odr && dc[j] == odc) movs += letras[j];
+        }
+        // deshacer el camino fijo del objetivo (al revés y con cada movimiento invertido)
+        for (size_t i = prefijo.size(); i-- > 0;) {
+            char m = prefijo[i];
+            movs += (m == 'U') ? 'D' : (m == 'D') ? 'U' : (m == 'L') ? 'R' : 'L';
+        }
+        return movs;
+    }
+
+private:
+    // las 8 simetrías del cuadrado como matrices 2x2 sobre (fila, columna), la identidad primero
+    static constexpr int MATRICES[8][4] = {
+        { 1, 0, 0, 1 }, { 0, 1, 1, 0 }, { -1, 0, 0, 1 }, { 1, 0, 0, -1 },
+        { -1, 0, 0, -1 }, { 0, -1, 1, 0 }, { 0, 1, -1, 0 }, { 0, -1, -1, 0 },
+    };
+
+    int n;
+    int simetria = 0;
+    string prefijo;       // movimientos que llevan el hueco del objetivo a una esquina
+    vector<int> etiqueta; // etiqueta[ficha original] = ficha en el objetivo canónico
+
+    void transformar(int r, int c, int& fr, int& fc) const {
+        const int* M = MATRICES[simetria];
+        fr = M[0] * r + M[1] * c + ((M[0] + M[1] < 0) ? n - 1 : 0);
+        fc = M[2] * r + M[3] * c + ((M[2] + M[3] < 0) ? n - 1 : 0);
+    }
+
+    vector<int> transformarTablero(const vector<int>& b) const {
+        vector<int> t(b.size());
+        for (int p = 0; p < n * n; ++p) {
+            int fr, fc;
+            transformar(p / n, p % n, fr, fc);
+            t[fr * n + fc] = b[p];
+        }
+        return t;
+    }
+};
+
+/* ---------------------- Presupuesto de memoria ---------------------- */
+
+/*
+  Lo que se agota en BFS es la RAM, no los nodos ni los segundos.
+  PresupuestoMemoria lleva la cuenta en bytes de lo que ocupan las estructuras de búsqueda:
+   - cada nodo de unordered_set / unordered_map: puntero "next" + hash guardado + contenido
+   - el texto de cada string si no cabe en el buffer interno (SSO) del propio string
+   - cada tablero en la cola: el vector<int> + sus n*n enteros en el heap
+   - los arreglos de cubetas (buckets) de las tablas hash, que se suman aparte
+  A cada bloque del heap se le suma la cabecera típica de malloc.
+*/
+const size_t SSO_CAPACIDAD = 15;        // caracteres que un std::string guarda sin pedir heap
+const size_t CABECERA_MALLOC = 16;      // bytes extra por cada bloque pedido al heap
+const size_t CLOCK_CADA_NODOS = 4096;   // leer el reloj solo cada tantos nodos
+
+// Nodos expandidos por los solves de este hilo: cada solve suma los suyos al salir (por
+// cualquier return, con RegistroNodos). --bench lo pone en 0 antes de cada corrida.
+thread_local size_t nodosExpandidos = 0;
+
+struct RegistroNodos {
+    const size_t& nodos;
+    ~RegistroNodos() { nodosExpandidos += nodos; }
+};
+
+struct PresupuestoMemoria {
+    size_t limiteBytes = 0; // presupuesto total
+    size_t usados = 0;      // bytes contabilizados en nodos/strings/tableros
+
+    bool excedido(size_t extraBuckets = 0) const { return usados + extraBuckets > limiteBytes; }
+};
+
+// bytes que ocupa un string fuera de su propio objeto
+size_t bytesHeapString(const string& s) {
+    return s.capacity() > SSO_CAPACIDAD ? s.capacity() + 1 + CABECERA_MALLOC : 0;
+}
+
+// bytes de un nodo de tabla hash cuyo contenido ocupa "contenido" bytes
+size_t bytesNodoHash(size_t contenido) {
+    return sizeof(void*) + sizeof(size_t) + contenido + CABECERA_MALLOC;
+}
+
+// bytes de los arreglos de cubetas de una tabla hash
+template <class Tabla>
+size_t bytesCubetas(const Tabla& t) {
+    return t.bucket_count() * sizeof(void*) + CABECERA_MALLOC;
+}
+
+/* ---------------------- Simetría del objetivo ---------------------- */
+
+/*
+  Simetría del objetivo: reflejar el tablero por la diagonal principal y renombrar las
+  fichas (la ficha que va en (f,c) pasa a ser la que va en (c,f)) deja el objetivo
+  1..N-1,0 igual. Un tablero y su transpuesto necesitan la misma cantidad de movimientos;
+  los movimientos se traducen cambiando U<->L y D<->R.
+*/
+vector<int> transponerTablero(const vector<int>& b, int n) {
+    vector<int> t(b.size());
+    for (int r = 0; r < n; ++r) {
+        for (int c = 0; c < n; ++c) {
+            int v = b[r * n + c];
+            if (v != 0) {
+                int p = v - 1;                  // casilla objetivo de v
+                v = (p % n) * n + (p / n) + 1;  // ficha que va en la casilla reflejada
             }
-            cout << "] ";
+            t[c * n + r] = v;
+        }
+    }
+    return t;
+}
+
+string transponerMovimientos(const string& movs) {
+    string t = movs;
+    for (char& m : t) {
+        if (m == 'U') m = 'L';
+        else if (m == 'L') m = 'U';
+        else if (m == 'D') m = 'R';
+        else if (m == 'R') m = 'D';
+    }
+    return t;
+}
+
+/* ---------------------- Bases de patrones (heurística) y tabla exacta 3x3 ---------------------- */
+
+/*
+  BasePatrones: base de datos de patrones aditiva y disjunta (n = 3 o 4).
+   - Las fichas 1..N-1 se reparten en grupos (3x3: 4+4, 4x4: 5+5+5).
+   - Para cada grupo se guarda, por cada ubicación posible de sus fichas, la menor
+     cantidad de movimientos de fichas DEL GRUPO para llevarlas a su lugar (BFS 0-1
+     desde el objetivo: mover el hueco sobre otra ficha cuesta 0).
+   - Como los grupos son disjuntos, la suma de los grupos sigue sin sobreestimar.
+   - h(b) = max(h_grupos(b), h_grupos(transpuesto(b))): el tablero reflejado tiene la
+     misma distancia al objetivo, así que la misma tabla da una segunda heurística gratis.
+*/
+class BasePatrones {
+public:
+    explicit BasePatrones(int n_) : n(n_), N(n_ * n_) {
+        int tamGrupo = (n == 3) ? 4 : 5;
+        for (int t = 1; t < N; t += tamGrupo) {
+            vector<int> g;
+            for (int v = t; v < t + tamGrupo && v < N; ++v) g.push_back(v);
+            grupos.push_back(g);
+        }
+        for (auto& g : grupos) tablas.push_back(construir(g));
+    }
+
+    int h(const vector<int>& b) const {
+        return max(hGrupos(b), hGrupos(transponerTablero(b, n)));
+    }
+
+    size_t bytes() const {
+        size_t total = 0;
+        for (auto& t : tablas) total += t.size();
+        return total;
+    }
+
+private:
+    int n, N;
+    vector<vector<int>> grupos;
+    vector<vector<uint8_t>> tablas; // una por grupo, indexada por indiceGrupo
+
+    int hGrupos(const vector<int>& b) const {
+        vector<int> pos(N);
+        for (int i = 0; i < N; ++i) pos[b[i]] = i;
+        int total = 0;
+        for (size_t g = 0; g < grupos.size(); ++g) {
+            int p[8];
+            for (size_t i = 0; i < grupos[g].size(); ++i) p[i] = pos[grupos[g][i]];
+            total += tablas[g][indiceGrupo(p, (int)grupos[g].size())];
+        }
+        return total;
+    }
+
+    // índice de una ubicación ordenada de k fichas distintas en N casillas: 0..N!/(N-k)!-1
+    size_t indiceGrupo(const int* p, int k) const {
+        size_t idx = 0;
+        for (int i = 0; i < k; ++i) {
+            int menores = 0;
+            for (int j = 0; j < i; ++j) if (p[j] < p[i]) ++menores;
+            idx = idx * (N - i) + (p[i] - menores);
+        }
+        return idx;
+    }
+
+    vector<uint8_t> construir(const vector<int>& grupo) {
+        int k = (int)grupo.size();
+        size_t total = 1;
+        for (int i = 0; i < k; ++i) total *= (N - i);
+
+        vector<uint8_t> tabla(total, 0xFF);
+        vector<char> visto(total * N, 0); // (ubicación, hueco)
+
+        // estado abstracto: posiciones del grupo empaquetadas de a 4 bits + hueco
+        struct Estado { uint64_t pos; int hueco; uint8_t costo; };
+        auto desempacar = [&](uint64_t pk, int* p) { for (int i = 0; i < k; ++i) p[i] = (pk >> (4 * i)) & 0xF; };
+
+        deque<Estado> dq;
+        uint64_t inicio = 0;
+        for (int i = 0; i < k; ++i) inicio |= (uint64_t)(grupo[i] - 1) << (4 * i);
+        dq.push_back({ inicio, N - 1, 0 });
+
+        int dr[4] = { -1, 1, 0, 0 };
+        int dc[4] = { 0, 0, -1, 1 };
+        int p[8];
+        while (!dq.empty()) {
+            Estado e = dq.front(); dq.pop_front();
+            desempacar(e.pos, p);
+            size_t idx = indiceGrupo(p, k);
+            if (visto[idx * N + e.hueco]) continue;
+            visto[idx * N + e.hueco] = 1;
+            if (tabla[idx] == 0xFF) tabla[idx] = e.costo; // BFS 0-1: el primero es el mínimo
+
+            for (int d = 0; d < 4; ++d) {
+                int nr = e.hueco / n + dr[d], nc = e.hueco % n + dc[d];
+                if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
+                int nh = nr * n + nc;
+                int ficha = -1;
+                for (int i = 0; i < k; ++i) if (p[i] == nh) { ficha = i; break; }
+                if (ficha < 0) {
+                    dq.push_front({ e.pos, nh, e.costo });           // costo 0
+                }
+                else {
+                    uint64_t np = (e.pos & ~((uint64_t)0xF << (4 * ficha))) | ((uint64_t)e.hueco << (4 * ficha));
+                    dq.push_back({ np, nh, (uint8_t)(e.costo + 1) }); // costo 1
+                }
+            }
+        }
+        return tabla;
+    }
+};
+
+/*
+  Rango de una permutación de 0..N-1 (código de Lehmer) y su inversa.
+*/
+uint32_t rangoPermutacion(const vector<int>& b) {
+    int N = (int)b.size();
+    uint32_t r = 0;
+    for (int i = 0; i < N; ++i) {
+        int menores = 0;
+        for (int j = i + 1; j < N; ++j) if (b[j] < b[i]) ++menores;
+        r = r * (N - i) + menores;
+    }
+    return r;
+}
+
+vector<int> permutacionDesdeRango(uint32_t r, int N) {
+    vector<int> digitos(N);
+    for (int i = N - 1; i >= 0; --i) { digitos[i] = r % (N - i); r /= (N - i); }
+    vector<int> libres(N), b(N);
+    for (int i = 0; i < N; ++i) libres[i] = i;
+    for (int i = 0; i < N; ++i) { b[i] = libres[digitos[i]]; libres.erase(libres.begin() + digitos[i]); }
+    return b;
+}
+
+/*
+  TablaExacta3x3: distancia óptima exacta de todos los tableros 3x3 solvables.
+  Un tablero y su transpuesto están a la misma distancia, así que solo se guardan
+  los representantes canónicos (el de menor rango de cada par):
+   - mapa de bits sobre los 9! rangos marcando los representantes canónicos solvables
+   - conteo acumulado cada 64 rangos (para pasar de rango a índice denso)
+   - un byte de distancia para cada uno de los ~91.000 representantes
+  Unos 160 KB en vez de 362 KB de una tabla de un byte por rango. El BFS que la
+  construye también recorre solo representantes canónicos (visitados comprimidos).
+*/
+class TablaExacta3x3 {
+public:
+    TablaExacta3x3() {
+        const uint32_t TOTAL = 362880; // 9!
+        bits.assign(TOTAL / 64 + 1, 0);
+        for (uint32_t r = 0; r < TOTAL; ++r) {
+            vector<int> b = permutacionDesdeRango(r, 9);
+            if (isSolvable(b, 3) && rangoCanonico(b) == r) bits[r / 64] |= (uint64_t)1 << (r % 64);
+        }
+        acumulado.assign(bits.size() + 1, 0);
+        for (size_t w = 0; w < bits.size(); ++w) acumulado[w + 1] = acumulado[w] + popcount64(bits[w]);
+        distancias.assign(acumulado.back(), SIN_VISITAR);
+
+        // BFS por capas desde el objetivo, sobre representantes canónicos
+        vector<int> goal = { 1, 2, 3, 4, 5, 6, 7, 8, 0 };
+        vector<uint32_t> capa{ rangoCanonico(goal) };
+        fijar(capa[0], 0);
+        int dr[4] = { -1, 1, 0, 0 };
+        int dc[4] = { 0, 0, -1, 1 };
+        for (int d = 1; !capa.empty(); ++d) {
+            vector<uint32_t> siguiente;
+            for (uint32_t r : capa) {
+                vector<int> b = permutacionDesdeRango(r, 9);
+                int zero = int(find(b.begin(), b.end(), 0) - b.begin());
+                for (int k = 0; k < 4; ++k) {
+                    int nr = zero / 3 + dr[k], nc = zero % 3 + dc[k];
+                    if (nr < 0 || nr >= 3 || nc < 0 || nc >= 3) continue;
+                    swap(b[zero], b[nr * 3 + nc]);
+                    uint32_t rc = rangoCanonico(b);
+                    if (leer(rc) == SIN_VISITAR) { fijar(rc, d); siguiente.push_back(rc); }
+                    swap(b[zero], b[nr * 3 + nc]);
+                }
+            }
+            capa.swap(siguiente);
+        }
+    }
+
+    // Distancia óptima al objetivo (-1 si no es solvable)
+    int distancia(const vector<int>& b) const {
+        if (!isSolvable(b, 3)) return -1;
+        return leer(rangoCanonico(b));
+    }
+
+    // Solución óptima: en cada paso ir al vecino que está un movimiento más cerca
+    string solucion(vector<int> b) const {
+        string movs;
+        int d = distancia(b);
+        if (d < 0) return movs;
+        const char mc[4] = { 'U','D','L','R' };
+        while (d > 0) {
+            EstadoTablero e(b, 3);
+            for (int k = 0; k < 4; ++k) {
+                if (!e.applyMove(k)) continue;
+                if (distancia(e.tablero()) == d - 1) { b = e.tablero(); movs += mc[k]; --d; break; }
+                e.undoMove(k);
+            }
+        }
+        return movs;
+    }
+
+    size_t bytes() const {
+        return bits.size() * sizeof(uint64_t) + acumulado.size() * sizeof(uint32_t) + distancias.size();
+    }
+
+private:
+    vector<uint64_t> bits;
+    vector<uint32_t> acumulado;
+    vector<uint8_t> distancias; // por índice denso
+    static constexpr uint8_t SIN_VISITAR = 0xFF;
+
+    static int popcount64(uint64_t x) {
+        int c = 0;
+        while (x) { x &= x - 1; ++c; }
+        return c;
+    }
 
-            setColor(7); // reset color
+    static uint32_t rangoCanonico(const vector<int>& b) {
+        return min(rangoPermutacion(b), rangoPermutacion(transponerTablero(b, 3)));
+    }
+
+    uint32_t indiceDenso(uint32_t r) const {
+        uint64_t antes = bits[r / 64] & (((uint64_t)1 << (r % 64)) - 1);
+        return acumulado[r / 64] + popcount64(antes);
+    }
+
+    int leer(uint32_t r) const { return distancias[indiceDenso(r)]; }
+    void fijar(uint32_t r, int d) { distancias[indiceDenso(r)] = (uint8_t)d; }
+};
+
+/* ---------------------- Distancia de caminata (walking distance) ---------------------- */
+
+/*
+  DistanciaCaminata: heurística de "walking distance" para n = 3 o 4.
+   - Para las filas se mira solo cuántas fichas de cada fila objetivo hay en cada fila
+     (una matriz n x n de conteos) y en qué fila está el hueco. Un movimiento vertical
+     pasa una ficha de la fila vecina a la fila del hueco.
+   - Se hace un BFS desde el objetivo sobre esas matrices (4x4: 24964 estados) y se guarda
+     la distancia de cada una y la transición para cada (dirección, fila objetivo de la ficha).
+   - Las columnas son lo mismo con la columna objetivo, así que la misma tabla sirve para
+     las dos: h = distancia(filas) + distancia(columnas), que no sobreestima (los movimientos
+     verticales y horizontales son distintos) y suele superar a manhattan + conflictos.
+  La búsqueda guarda los dos índices y los actualiza en O(1) con siguiente() al mover el hueco.
+  Después de construir quedan las distancias, las transiciones y un índice ordenado (< 1 MB).
+*/
+class DistanciaCaminata {
+public:
+    explicit DistanciaCaminata(int n_) : n(n_) {
+        int c[4][4] = {};
+        for (int r = 0; r < n; ++r) c[r][r] = n;
+        c[n - 1][n - 1] = n - 1; // el hueco está en la última fila
+        agregar(codificar(c, n - 1), 0);
+
+        for (size_t i = 0; i < estados.size(); ++i) { // BFS: "estados" es la cola
+            int hueco = decodificar(estados[i], c);
+            for (int dir = 0; dir < 2; ++dir) {
+                int vecina = hueco + (dir == 0 ? -1 : 1);
+                if (vecina < 0 || vecina >= n) continue;
+                for (int g = 0; g < n; ++g) {
+                    if (c[vecina][g] == 0) continue;
+                    c[vecina][g]--; c[hueco][g]++;
+                    uint64_t clave = codificar(c, vecina);
+                    auto it = indicesBFS.find(clave);
+                    int j = (it != indicesBFS.end()) ? it->second : agregar(clave, distancias[i] + 1);
+                    transiciones[(i * 2 + dir) * n + g] = (uint16_t)j;
+                    c[vecina][g]++; c[hueco][g]--;
+                }
+            }
+        }
+
+        // para buscar el índice de un tablero basta un arreglo ordenado por clave
+        for (auto& kv : indicesBFS) indices.push_back({ kv.first, kv.second });
+        sort(indices.begin(), indices.end());
+        unordered_map<uint64_t, int>().swap(indicesBFS);
+        vector<uint64_t>().swap(estados);
+    }
+
+    int tamano() const { return n; }
+
+    // índice de las filas (filas = true) o de las columnas del tablero b
+    int indice(const vector<int>& b, bool filas) const {
+        int c[4][4] = {};
+        int hueco = 0;
+        for (int i = 0; i < n * n; ++i) {
+            int linea = filas ? i / n : i % n;
+            if (b[i] == 0) { hueco = linea; continue; }
+            c[linea][filas ? (b[i] - 1) / n : (b[i] - 1) % n]++;
+        }
+        uint64_t clave = codificar(c, hueco);
+        auto it = lower_bound(indices.begin(), indices.end(), make_pair(clave, 0));
+        return it->second;
+    }
+
+    // estado tras mover el hueco a la fila (o columna) anterior (dir = 0) o siguiente (dir = 1),
+    // pasando una ficha cuya fila (o columna) objetivo es "grupo"
+    int siguiente(int idx, int dir, int grupo) const { return transiciones[((size_t)idx * 2 + dir) * n + grupo]; }
+
+    int distancia(int idx) const { return distancias[idx]; }
+
+    int h(const vector<int>& b) const { return distancias[indice(b, true)] + distancias[indice(b, false)]; }
+
+    size_t bytes() const {
+        return distancias.size() + transiciones.size() * sizeof(uint16_t) + indices.size() * sizeof(indices[0]);
+    }
+
+private:
+    int n;
+    vector<uint8_t> distancias;
+    vector<uint16_t> transiciones;         // [(idx * 2 + dir) * n + grupo] (4x4: 24964 estados < 2^16)
+    vector<pair<uint64_t, int>> indices;   // (clave, índice) ordenado por clave
+
+    // solo durante la construcción
+    vector<uint64_t> estados;              // cola del BFS
+    unordered_map<uint64_t, int> indicesBFS;
+
+    // conteos de a 3 bits (como mucho 4 fichas) y la fila del hueco arriba de todo
+    uint64_t codificar(const int c[4][4], int hueco) const {
+        uint64_t k = 0;
+        for (int r = 0; r < n; ++r)
+            for (int g = 0; g < n; ++g) k |= (uint64_t)c[r][g] << (3 * (r * n + g));
+        return k | ((uint64_t)hueco << 48);
+    }
+
+    int decodificar(uint64_t k, int c[4][4]) const {
+        for (int r = 0; r < n; ++r)
+            for (int g = 0; g < n; ++g) c[r][g] = (k >> (3 * (r * n + g))) & 7;
+        return (int)(k >> 48);
+    }
+
+    int agregar(uint64_t clave, int d) {
+        indicesBFS[clave] = (int)estados.size();
+        estados.push_back(clave);
+        distancias.push_back((uint8_t)d);
+        transiciones.resize(transiciones.size() + 2 * n, 0xFFFF); // 0xFFFF = imposible
+        return (int)estados.size() - 1;
+    }
+};
+
+/* ---------------------- Autómata de poda de movimientos ---------------------- */
+
+/*
+  AutomataPoda: prohíbe secuencias de movimientos que solo repiten tableros ya alcanzables
+  por un camino más corto (o igual de largo y menor en el orden U < D < L < R).
+  Se construye una sola vez con un BFS corto sobre secuencias de movimientos del hueco en
+  un tablero grande, con el hueco en el centro para que los bordes no influyan:
+   - si una secuencia deja el mismo tablero que otra anterior que no se sale de sus mismas
+     filas/columnas, la secuencia se prohíbe;
+   - con las secuencias prohibidas se arma un autómata de Aho-Corasick.
+  Cada nodo de la búsqueda guarda un estado del autómata y cada movimiento es una consulta
+  a la tabla "transicion" (-1 = podar). Con longitud 2 es la poda de siempre (no deshacer
+  el último movimiento); con 8 también poda, por ejemplo, dar dos vueltas a un cuadrado
+  de 2x2, que equivale a una vuelta en sentido contrario.
+  Movimientos: 0 = U, 1 = D, 2 = L, 3 = R.
+*/
+struct AutomataPoda {
+    vector<array<int, 4>> transicion; // transicion[estado][mov] = siguiente estado o -1
+
+    explicit AutomataPoda(int longitudMaxima = 8) {
+        int L = longitudMaxima;
+        int W = 2 * L + 1; // tablero W x W, el hueco nunca llega al borde
+        int dr[4] = { -1, 1, 0, 0 };
+        int dc[4] = { 0, 0, -1, 1 };
+
+        struct Secuencia {
+            string movs;
+            vector<uint16_t> tablero;
+            int hueco;
+            int caja[4]; // fila mínima, fila máxima, columna mínima, columna máxima
+        };
+        auto contenida = [](const int* a, const int* b) { // caja a dentro de caja b
+            return a[0] >= b[0] && a[1] <= b[1] && a[2] >= b[2] && a[3] <= b[3];
+        };
+
+        Secuencia ini;
+        ini.tablero.resize(W * W);
+        for (int i = 0; i < W * W; ++i) ini.tablero[i] = (uint16_t)i;
+        ini.hueco = L * W + L;
+        ini.caja[0] = ini.caja[1] = ini.caja[2] = ini.caja[3] = L;
+
+        map<vector<uint16_t>, array<int, 4>> vistos; // tablero -> caja de la primera secuencia
+        vistos[ini.tablero] = { L, L, L, L };
+        set<string> prohibidas;
+
+        vector<Secuencia> capa{ ini };
+        for (int len = 1; len <= L; ++len) {
+            vector<Secuencia> siguiente;
+            for (auto& s : capa) {
+                for (int k = 0; k < 4; ++k) {
+                    string t = s.movs + (char)('0' + k);
+                    bool yaPodada = false; // algún sufijo ya está prohibido
+                    for (size_t i = 1; i + 1 < t.size() && !yaPodada; ++i)
+                        yaPodada = prohibidas.count(t.substr(i)) > 0;
+                    if (yaPodada) continue;
+
+                    Secuencia x = s;
+                    int nr = x.hueco / W + dr[k], nc = x.hueco % W + dc[k];
+                    int nh = nr * W + nc;
+                    swap(x.tablero[x.hueco], x.tablero[nh]);
+                    x.hueco = nh;
+                    x.movs = t;
+                    x.caja[0] = min(x.caja[0], nr); x.caja[1] = max(x.caja[1], nr);
+                    x.caja[2] = min(x.caja[2], nc); x.caja[3] = max(x.caja[3], nc);
+
+                    auto it = vistos.find(x.tablero);
+                    if (it == vistos.end()) {
+                        vistos[x.tablero] = { x.caja[0], x.caja[1], x.caja[2], x.caja[3] };
+                    }
+                    else if (contenida(it->second.data(), x.caja)) {
+                        prohibidas.insert(t); // repite un tablero por un camino que también cabe
+                        continue;
+                    }
+                    siguiente.push_back(move(x));
+                }
+            }
+            capa.swap(siguiente);
+        }
+
+        // trie de las secuencias prohibidas
+        vector<array<int, 4>> hijos(1, { -1, -1, -1, -1 });
+        vector<char> terminal(1, 0);
+        for (auto& t : prohibidas) {
+            int u = 0;
+            for (char ch : t) {
+                int k = ch - '0';
+                if (hijos[u][k] < 0) {
+                    hijos[u][k] = (int)hijos.size();
+                    hijos.push_back({ -1, -1, -1, -1 });
+                    terminal.push_back(0);
+                }
+                u = hijos[u][k];
+            }
+            terminal[u] = 1;
+        }
+
+        // enlaces de falla (Aho-Corasick) y tabla de transiciones completa
+        vector<int> falla(hijos.size(), 0);
+        transicion = hijos;
+        queue<int> q;
+        for (int k = 0; k < 4; ++k) {
+            if (hijos[0][k] >= 0) q.push(hijos[0][k]);
+            else transicion[0][k] = 0;
+        }
+        while (!q.empty()) {
+            int u = q.front(); q.pop();
+            terminal[u] |= terminal[falla[u]];
+            for (int k = 0; k < 4; ++k) {
+                int v = hijos[u][k];
+                if (v >= 0) { falla[v] = transicion[falla[u]][k]; q.push(v); }
+                else transicion[u][k] = transicion[falla[u]][k];
+            }
+        }
+        for (auto& fila : transicion)
+            for (int k = 0; k < 4; ++k)
+                if (terminal[fila[k]]) fila[k] = -1;
+    }
+};
+
+/* ---------------------- Búsqueda de perímetro (vecindario del objetivo) ---------------------- */
+
+/*
+  TablaPerimetro: todos los tableros a distancia <= profundidad del objetivo (n <= 4), con su
+  distancia exacta. Se arma con un BFS por capas desde el objetivo sobre tableros empaquetados
+  (4 bits por ficha, el formato de EstadoTablero::clave) y se guarda en una tabla hash de
+  direccionamiento abierto: un arreglo de claves y otro paralelo de distancias (9 bytes por
+  casilla, ocupación <= 1/2). La misma tabla hace de conjunto de visitados durante el BFS.
+  En la búsqueda:
+   - dentro del perímetro la distancia es exacta: no hace falta bajar hasta el objetivo;
+   - fuera del perímetro la distancia es al menos profundidad + 1 (cota inferior extra).
+  El tamaño crece más o menos como 2.1^profundidad en 4x4 (profundidad 14: ~62 mil, ~1.2 MB).
+*/
+class TablaPerimetro {
+public:
+    TablaPerimetro(int n_, int profundidad_) : n(n_), d(profundidad_), claves(1024, 0), distancias(1024, 0) {
+        int N = n * n;
+        vector<int> goal(N);
+        for (int i = 0; i < N - 1; ++i) goal[i] = i + 1;
+        goal[N - 1] = 0;
+
+        EstadoTablero objetivo(goal, n);
+        vector<uint64_t> capa{ objetivo.clave() };
+        insertar(objetivo.clave(), 0);
+        int dr[4] = { -1, 1, 0, 0 };
+        int dc[4] = { 0, 0, -1, 1 };
+        for (int prof = 1; prof <= d && !capa.empty(); ++prof) {
+            vector<uint64_t> siguiente;
+            for (uint64_t s : capa) {
+                int zero = 0;
+                while (((s >> (4 * zero)) & 0xF) != 0) ++zero;
+                for (int k = 0; k < 4; ++k) {
+                    int nr = zero / n + dr[k], nc = zero % n + dc[k];
+                    if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
+                    int nz = nr * n + nc;
+                    uint64_t v = (s >> (4 * nz)) & 0xF;
+                    uint64_t hijo = s ^ (v << (4 * nz)) ^ (v << (4 * zero));
+                    if (insertar(hijo, (uint8_t)prof)) siguiente.push_back(hijo);
+                }
+            }
+            capa.swap(siguiente);
+        }
+    }
+
+    int tamano() const { return n; }
+    int profundidad() const { return d; }
+    size_t size() const { return ocupadas; }
+    size_t bytes() const { return claves.capacity() * sizeof(uint64_t) + distancias.capacity(); }
+
+    // distancia exacta al objetivo, o -1 si el tablero está fuera del perímetro
+    int distancia(uint64_t clave) const {
+        size_t mask = claves.size() - 1;
+        for (size_t i = mezclar(clave) & mask;; i = (i + 1) & mask) {
+            if (claves[i] == clave) return distancias[i];
+            if (claves[i] == 0) return -1;
+        }
+    }
+
+    // movimientos óptimos desde un tablero del perímetro hasta el objetivo
+    string caminoAlObjetivo(const vector<int>& b) const {
+        static const char mc[4] = { 'U', 'D', 'L', 'R' };
+        EstadoTablero e(b, n);
+        string movs;
+        for (int dist = distancia(e.clave()); dist > 0; --dist) {
+            for (int k = 0; k < 4; ++k) {
+                if (!e.applyMove(k)) continue;
+                if (distancia(e.clave()) == dist - 1) { movs += mc[k]; break; }
+                e.undoMove(k);
+            }
+        }
+        return movs;
+    }
+
+private:
+    int n, d;
+    vector<uint64_t> claves;    // 0 = libre (ningún tablero empaquetado vale 0)
+    vector<uint8_t> distancias;
+    size_t ocupadas = 0;
+
+    static uint64_t mezclar(uint64_t x) { // splitmix64, como TablaVisitados
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // true si la clave no estaba
+    bool insertar(uint64_t clave, uint8_t dist) {
+        if ((ocupadas + 1) * 2 > claves.size()) crecer();
+        size_t mask = claves.size() - 1;
+        for (size_t i = mezclar(clave) & mask;; i = (i + 1) & mask) {
+            if (claves[i] == clave) return false;
+            if (claves[i] == 0) { claves[i] = clave; distancias[i] = dist; ++ocupadas; return true; }
+        }
+    }
+
+    void crecer() {
+        vector<uint64_t> viejasClaves(claves.size() * 2, 0);
+        vector<uint8_t> viejasDist(claves.size() * 2, 0);
+        viejasClaves.swap(claves);
+        viejasDist.swap(distancias);
+        ocupadas = 0;
+        for (size_t i = 0; i < viejasClaves.size(); ++i)
+            if (viejasClaves[i]) insertar(viejasClaves[i], viejasDist[i]);
+    }
+};
+
+const int PROFUNDIDAD_PERIMETRO = 14;
+
+// la tabla de perímetro de n x n, construida la primera vez que se pide; nullptr si n > 4
+const TablaPerimetro* perimetroPara(int n) {
+    switch (n) {
+    case 2: { static const TablaPerimetro t(2, PROFUNDIDAD_PERIMETRO); return &t; }
+    case 3: { static const TablaPerimetro t(3, PROFUNDIDAD_PERIMETRO); return &t; }
+    case 4: { static const TablaPerimetro t(4, PROFUNDIDAD_PERIMETRO); return &t; }
+    default: return nullptr;
+    }
+}
+
+/* ---------------------- Tableros de tamaño fijo (plantillas sobre n) ---------------------- */
+
+/*
+  Board<N>: tablero N x N con el tamaño conocido en compilación.
+   - Casillas en un std::array<uint8_t, N*N> (sin memoria dinámica, cabe en pocas líneas de caché).
+   - El objetivo, los vecinos de cada casilla y las distancias manhattan son tablas constexpr
+     (tablaObjetivo / tablaVecinos / tablaDistancias), así los bucles sobre el tablero tienen
+     límites constantes y el compilador puede desenrollarlos.
+  Los resolutores se instancian para N = 2..8 y se elige la instancia una sola vez según el
+  n del usuario (ver idaSolve); para n mayores queda la versión dinámica con vector<int>.
+*/
+const int N_FIJO_MAXIMO = 8;
+
+template <int N>
+constexpr array<uint8_t, N * N> tablaObjetivo() {
+    array<uint8_t, N * N> t{};
+    for (int i = 0; i < N * N - 1; ++i) t[i] = (uint8_t)(i + 1);
+    t[N * N - 1] = 0;
+    return t;
+}
+
+// vecinos[pos][k] = casilla a la que pasa el hueco con el movimiento k (U, D, L, R), -1 = fuera
+template <int N>
+constexpr array<array<int8_t, 4>, N * N> tablaVecinos() {
+    array<array<int8_t, 4>, N * N> t{};
+    for (int p = 0; p < N * N; ++p) {
+        int r = p / N, c = p % N;
+        t[p][0] = (int8_t)(r > 0 ? p - N : -1);
+        t[p][1] = (int8_t)(r < N - 1 ? p + N : -1);
+        t[p][2] = (int8_t)(c > 0 ? p - 1 : -1);
+        t[p][3] = (int8_t)(c < N - 1 ? p + 1 : -1);
+    }
+    return t;
+}
+
+// distancias[ficha][pos] = distancia manhattan de la ficha en pos a su lugar (hueco = 0)
+template <int N>
+constexpr array<array<uint8_t, N * N>, N * N> tablaDistancias() {
+    array<array<uint8_t, N * N>, N * N> t{};
+    for (int v = 1; v < N * N; ++v)
+        for (int p = 0; p < N * N; ++p) {
+            int dr = p / N - (v - 1) / N, dc = p % N - (v - 1) % N;
+            t[v][p] = (uint8_t)((dr < 0 ? -dr : dr) + (dc < 0 ? -dc : dc));
+        }
+    return t;
+}
+
+template <int N> constexpr array<uint8_t, N * N> OBJETIVO_FIJO = tablaObjetivo<N>();
+template <int N> constexpr array<array<int8_t, 4>, N * N> VECINOS_FIJO = tablaVecinos<N>();
+template <int N> constexpr array<array<uint8_t, N * N>, N * N> DISTANCIAS_FIJO = tablaDistancias<N>();
+
+template <int N>
+struct Board {
+    static constexpr int CELDAS = N * N;
+    array<uint8_t, CELDAS> celdas;
+    int hueco;
+    int distancia;                  // suma manhattan, se actualiza al mover
+    uint64_t clave;                 // empaquetado de a 4 bits (solo N <= 4), como EstadoTablero::clave
+    array<int, N> conflictosFila;   // conflictosLinea de cada fila / columna
+    array<int, N> conflictosColumna;
+    int conflictos;
+
+    static Board desdeVector(const vector<int>& b) {
+        Board t;
+        t.distancia = 0;
+        t.clave = 0;
+        for (int i = 0; i < CELDAS; ++i) {
+            t.celdas[i] = (uint8_t)b[i];
+            if (b[i] == 0) t.hueco = i;
+            t.distancia += DISTANCIAS_FIJO<N>[b[i]][i];
+            if constexpr (N <= 4) t.clave |= (uint64_t)b[i] << (4 * i);
+        }
+        t.conflictos = 0;
+        for (int l = 0; l < N; ++l) {
+            t.conflictosFila[l] = t.conflictosDe(l, true);
+            t.conflictosColumna[l] = t.conflictosDe(l, false);
+            t.conflictos += t.conflictosFila[l] + t.conflictosColumna[l];
+        }
+        return t;
+    }
+
+    vector<int> aVector() const { return vector<int>(celdas.begin(), celdas.end()); }
+
+    bool esObjetivo() const { return celdas == OBJETIVO_FIJO<N>; }
+
+    int manhattan() const { return distancia; }
+
+    // manhattan + conflictos lineales (igual que EstadoTablero::heuristica)
+    int heuristica() const { return distancia + 2 * conflictos; }
+
+    // mueve el hueco con el movimiento k; false si se sale del tablero.
+    // Como EstadoTablero::applyMove: manhattan en O(1) y conflictos solo de las dos líneas que cambian.
+    bool mover(int k) {
+        int nz = VECINOS_FIJO<N>[hueco][k];
+        if (nz < 0) return false;
+        int v = celdas[nz];
+        distancia += DISTANCIAS_FIJO<N>[v][hueco] - DISTANCIAS_FIJO<N>[v][nz];
+        if constexpr (N <= 4) clave ^= ((uint64_t)v << (4 * nz)) ^ ((uint64_t)v << (4 * hueco));
+        celdas[hueco] = (uint8_t)v;
+        celdas[nz] = 0;
+
+        bool vertical = k < 2;
+        array<int, N>& lineas = vertical ? conflictosFila : conflictosColumna;
+        int a = vertical ? nz / N : nz % N;
+        int b = vertical ? hueco / N : hueco % N;
+        hueco = nz;
+        conflictos -= lineas[a] + lineas[b];
+        lineas[a] = conflictosDe(a, vertical);
+        lineas[b] = conflictosDe(b, vertical);
+        conflictos += lineas[a] + lineas[b];
+        return true;
+    }
+
+    int conflictosDe(int linea, bool esFila) const {
+        int fichas[N], trabajo[2 * N];
+        for (int i = 0; i < N; ++i) fichas[i] = esFila ? celdas[linea * N + i] : celdas[i * N + linea];
+        return conflictosLinea(fichas, N, linea, esFila, trabajo);
+    }
+};
+
+/* ---------------------- IDA* (respaldo cuando BFS se queda sin memoria) ---------------------- */
+
+// autómata compartido por todas las versiones del IDA* (se construye en la primera llamada)
+const AutomataPoda& automataIDA() {
+    static const AutomataPoda automata(8);
+    return automata;
+}
+
+/*
+  idaSolve:
+    - Profundización iterativa con cota f = g + h (h = manhattan + conflictos lineales de
+      EstadoTablero, o la BasePatrones si se pasa).
+    - Memoria O(profundidad): solo guarda el camino actual.
+    - Los movimientos redundantes se podan con AutomataPoda (una consulta de tabla por hijo).
+    - deadline: instante límite compartido con quien lo llama (por ejemplo bfsSolve).
+  Para n = 2..N_FIJO_MAXIMO se usa la instancia IdaFijo<N> (Board<N>); si no, idaSolveDinamico.
+  Devuelve el mismo formato que bfsSolve.
+*/
+pair<bool, vector<string>> idaSolveDinamico(const vector<int>& start, int n, chrono::steady_clock::time_point deadline,
+                                            const BasePatrones* pdb)
+{
+    vector<string> emptyRes;
+    if (!isSolvable(start, n)) return { false, emptyRes };
+
+    const int FOUND = -1;
+    const int ABORT = -2;
+
+    EstadoTablero cur(start, n);         // se mueve y se deshace en el lugar
+    vector<vector<int>> camino{ start }; // tableros de la rama actual
+    size_t nodes = 0;
+    RegistroNodos registro{ nodes };
+
+    const AutomataPoda& automata = automataIDA();
+
+    // devuelve FOUND, ABORT o la menor f que superó la cota
+    function<int(int, int, int)> dfs = [&](int g, int bound, int estadoAut) -> int {
+        if (++nodes % CLOCK_CADA_NODOS == 0 && chrono::steady_clock::now() > deadline) return ABORT;
+
+        int h = pdb ? pdb->h(cur.tablero()) : cur.heuristica(); // heuristica: O(1), ya actualizada
+        int f = g + h;
+        if (f > bound) return f;
+        if (h == 0) return FOUND;
+
+        int minimo = INT_MAX;
+        for (int k = 0; k < 4; ++k) {
+            int sigAut = automata.transicion[estadoAut][k];
+            if (sigAut < 0) continue; // secuencia redundante (incluye deshacer el último movimiento)
+            if (!cur.applyMove(k)) continue;
+
+            camino.push_back(cur.tablero());
+            int t = dfs(g + 1, bound, sigAut);
+            if (t == FOUND) return FOUND;
+            camino.pop_back();
+            cur.undoMove(k);
+            if (t == ABORT) return ABORT;
+            if (t < minimo) minimo = t;
+        }
+        return minimo;
+    };
+
+    int bound = pdb ? pdb->h(start) : cur.heuristica();
+    while (true) {
+        int t = dfs(0, bound, 0);
+        if (t == FOUND) break;
+        if (t == ABORT || t == INT_MAX) return { false, emptyRes };
+        bound = t;
+    }
+
+    vector<string> path;
+    for (auto& b : camino) path.push_back(boardToKey(b));
+    return { true, path };
+}
+
+/*
+  IdaFijo<N>: el mismo IDA* sobre Board<N>. Los vecinos y la heurística salen de las tablas
+  constexpr y la rama se guarda como arreglo de Board<N> (copias de tamaño fijo).
+*/
+template <int N>
+struct IdaFijo {
+    static const int FOUND = -1;
+    static const int ABORT = -2;
+
+    Board<N> cur;
+    vector<Board<N>> camino;
+    const BasePatrones* pdb;
+    const DistanciaCaminata* wd;  // nullptr = sin walking distance
+    int wdFila = 0, wdColumna = 0; // índices de DistanciaCaminata, se actualizan al mover
+    const TablaPerimetro* perimetro; // nullptr = bajar hasta el objetivo
+    bool dentroPerimetro = false;    // lo deja h(): el nodo actual está en la tabla
+    string cola;                     // al encontrar: movimientos desde el perímetro al objetivo
+    const AutomataPoda& automata;
+    chrono::steady_clock::time_point deadline;
+    size_t nodes = 0;
+    vector<int> auxiliar; // tablero como vector para la BasePatrones
+
+    IdaFijo(const Board<N>& inicio, const BasePatrones* pdb_, const DistanciaCaminata* wd_,
+            const TablaPerimetro* perimetro_, const AutomataPoda& automata_, chrono::steady_clock::time_point deadline_)
+        : cur(inicio), camino{ inicio }, pdb(pdb_), wd(wd_), perimetro(perimetro_), automata(automata_),
+          deadline(deadline_), auxiliar(N * N)
+    {
+        if (wd) {
+            vector<int> b = inicio.aVector();
+            wdFila = wd->indice(b, true);
+            wdColumna = wd->indice(b, false);
+        }
+    }
+
+    // máximo de las heurísticas disponibles (todas admisibles)
+    int h() {
+        int hv;
+        if (!pdb) hv = cur.heuristica();
+        else {
+            for (int i = 0; i < N * N; ++i) auxiliar[i] = cur.celdas[i];
+            hv = pdb->h(auxiliar);
+        }
+        if (wd) hv = max(hv, wd->distancia(wdFila) + wd->distancia(wdColumna));
+        dentroPerimetro = false;
+        if (perimetro && hv <= perimetro->profundidad()) { // con hv mayor no puede estar adentro
+            int exacta = perimetro->distancia(cur.clave);
+            dentroPerimetro = exacta >= 0;
+            // afuera: al menos profundidad + 1, redondeado a la paridad de la distancia real, que
+            // es la de manhattan (cada movimiento la cambia en 1). No se toma la de hv: la
+            // BasePatrones y la walking distance no conservan la paridad.
+            int afuera = perimetro->profundidad() + 1;
+            if ((afuera - cur.manhattan()) % 2 != 0) ++afuera;
+            hv = dentroPerimetro ? exacta : afuera;
+        }
+        return hv;
+    }
+
+    // la ficha v se movió con el movimiento k del hueco (U/D cambian filas, L/R columnas)
+    void moverCaminata(int k, int v) {
+        if (k < 2) wdFila = wd->siguiente(wdFila, k, (v - 1) / N);
+        else wdColumna = wd->siguiente(wdColumna, k - 2, (v - 1) % N);
+    }
+
+    // devuelve FOUND, ABORT o la menor f que superó la cota
+    int dfs(int g, int bound, int estadoAut) {
+        if (++nodes % CLOCK_CADA_NODOS == 0 && chrono::steady_clock::now() > deadline) return ABORT;
+
+        int hv = h();
+        int f = g + hv;
+        if (f > bound) return f;
+        if (hv == 0) return FOUND;
+        if (dentroPerimetro) { // el resto del camino sale de la tabla
+            cola = perimetro->caminoAlObjetivo(cur.aVector());
+            return FOUND;
+        }
+
+        int minimo = INT_MAX;
+        for (int k = 0; k < 4; ++k) {
+            int sigAut = automata.transicion[estadoAut][k];
+            if (sigAut < 0) continue;
+            int nz = VECINOS_FIJO<N>[cur.hueco][k];
+            if (nz < 0) continue;
+            int v = cur.celdas[nz];
+            cur.mover(k);
+            if (wd) moverCaminata(k, v);
+            camino.push_back(cur);
+            int t = dfs(g + 1, bound, sigAut);
+            if (t == FOUND) return FOUND;
+            camino.pop_back();
+            cur.mover(k ^ 1); // deshacer: el movimiento inverso es k ^ 1
+            if (wd) moverCaminata(k ^ 1, v);
+            if (t == ABORT) return ABORT;
+            if (t < minimo) minimo = t;
+        }
+        return minimo;
+    }
+};
+
+template <int N>
+pair<bool, vector<string>> idaSolveFijo(const vector<int>& start, chrono::steady_clock::time_point deadline,
+                                        const BasePatrones* pdb, const DistanciaCaminata* wd,
+                                        const TablaPerimetro* perimetro)
+{
+    vector<string> emptyRes;
+    if (!isSolvable(start, N)) return { false, emptyRes };
+    if (wd && wd->tamano() != N) wd = nullptr; // tablas de otro tamaño
+    if (perimetro && perimetro->tamano() != N) perimetro = nullptr;
+
+    IdaFijo<N> busqueda(Board<N>::desdeVector(start), pdb, wd, perimetro, automataIDA(), deadline);
+    RegistroNodos registro{ busqueda.nodes };
+
+    int bound = busqueda.h();
+    while (true) {
+        int t = busqueda.dfs(0, bound, 0);
+        if (t == IdaFijo<N>::FOUND) break;
+        if (t == IdaFijo<N>::ABORT || t == INT_MAX) return { false, emptyRes };
+        bound = t;
+    }
+
+    vector<string> path;
+    for (auto& b : busqueda.camino) path.push_back(boardToKey(b.aVector()));
+    Board<N> fin = busqueda.cur;
+    for (char m : busqueda.cola) { // tramo final dentro del perímetro
+        fin.mover(int(string("UDLR").find(m)));
+        path.push_back(boardToKey(fin.aVector()));
+    }
+    return { true, path };
+}
+
+// elige la instancia de tamaño fijo según n (una sola vez por resolución).
+// wd: DistanciaCaminata del mismo n (opcional); se combina con la otra heurística tomando el máximo.
+// perimetro: TablaPerimetro del mismo n (opcional); la búsqueda se detiene al entrar en él.
+pair<bool, vector<string>> idaSolve(const vector<int>& start, int n, chrono::steady_clock::time_point deadline,
+                                    const BasePatrones* pdb = nullptr, const DistanciaCaminata* wd = nullptr,
+                                    const TablaPerimetro* perimetro = nullptr)
+{
+    switch (n) {
+    case 2: return idaSolveFijo<2>(start, deadline, pdb, wd, perimetro);
+    case 3: return idaSolveFijo<3>(start, deadline, pdb, wd, perimetro);
+    case 4: return idaSolveFijo<4>(start, deadline, pdb, wd, perimetro);
+    case 5: return idaSolveFijo<5>(start, deadline, pdb, wd, perimetro);
+    case 6: return idaSolveFijo<6>(start, deadline, pdb, wd, perimetro);
+    case 7: return idaSolveFijo<7>(start, deadline, pdb, wd, perimetro);
+    case 8: return idaSolveFijo<8>(start, deadline, pdb, wd, perimetro);
+    default: return idaSolveDinamico(start, n, deadline, pdb);
+    }
+}
+
+/* ---------------------- Puntos de control en disco ---------------------- */
+
+/*
+  Una búsqueda larga guarda cada tanto su estado en un archivo (punto de control) para poder
+  seguir después de un timeout, una interrupción o una caída, en vez de empezar de cero.
+  El archivo se escribe completo en ruta + ".tmp", se fuerza a disco y recién entonces se
+  renombra sobre ruta: quien lo lea ve el punto anterior o el nuevo, nunca uno a medias.
+*/
+const int SEGUNDOS_ENTRE_PUNTOS = 60; // cada cuánto se guarda mientras la búsqueda avanza
+
+bool escribirAtomico(const string& ruta, const function<bool(FILE*)>& escribir) {
+    string tmp = ruta + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = escribir(f) && fflush(f) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(f)) == 0;
+#else
+    ok = ok && fsync(fileno(f)) == 0;
+#endif
+    ok = (fclose(f) == 0) && ok;
+#ifdef _WIN32
+    ok = ok && MoveFileExA(tmp.c_str(), ruta.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    ok = ok && rename(tmp.c_str(), ruta.c_str()) == 0;
+#endif
+    if (!ok) remove(tmp.c_str());
+    return ok;
+}
+
+// Lectura de un punto de control: lleva la cuenta de los bytes que quedan para no creerle
+// a un tamaño corrupto (un archivo truncado o ajeno simplemente no se carga).
+struct LectorPunto {
+    FILE* f = nullptr;
+    uint64_t restante = 0;
+
+    LectorPunto(const string& ruta) {
+        error_code ec;
+        uintmax_t tam = filesystem::file_size(ruta, ec);
+        if (ec) return;
+        f = fopen(ruta.c_str(), "rb");
+        restante = tam;
+    }
+    ~LectorPunto() { if (f) fclose(f); }
+
+    bool leer(void* p, size_t bytes) {
+        if (!f || bytes > restante || fread(p, 1, bytes, f) != bytes) return false;
+        restante -= bytes;
+        return true;
+    }
+};
+
+template <typename T>
+bool escribirArreglo(FILE* f, const vector<T>& v) {
+    uint64_t cantidad = v.size();
+    return fwrite(&cantidad, sizeof(cantidad), 1, f) == 1 &&
+           (v.empty() || fwrite(v.data(), sizeof(T), v.size(), f) == v.size());
+}
+
+template <typename T>
+bool leerArreglo(LectorPunto& lector, vector<T>& v) {
+    uint64_t cantidad;
+    if (!lector.leer(&cantidad, sizeof(cantidad)) || cantidad > lector.restante / sizeof(T)) return false;
+    v.resize((size_t)cantidad);
+    return lector.leer(v.data(), v.size() * sizeof(T));
+}
+
+/* ---------------------- Frontera BFS en arreglos contiguos (estructura de arreglos) ---------------------- */
+
+/*
+  Tableros de hasta 16 casillas (n <= 4) empaquetados en un uint64_t, 4 bits por ficha.
+*/
+uint64_t empaquetarTablero(const vector<int>& b) {
+    uint64_t s = 0;
+    for (size_t i = 0; i < b.size(); ++i) s |= (uint64_t)b[i] << (4 * i);
+    return s;
+}
+
+vector<int> desempaquetarTablero(uint64_t s, int N) {
+    vector<int> b(N);
+    for (int i = 0; i < N; ++i) b[i] = (int)((s >> (4 * i)) & 0xF);
+    return b;
+}
+
+// Prefetch de la línea de caché donde está p (no cambia el resultado, solo adelanta la lectura)
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(p) __builtin_prefetch(p)
+#elif defined(_MSC_VER)
+#include <xmmintrin.h>
+#define PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#else
+#define PREFETCH(p) ((void)0)
+#endif
+
+/*
+  Una capa del BFS guardada como estructura de arreglos: en vez de una cola de vector<int>
+  (cada tablero en su propio bloque del heap) hay tres arreglos contiguos del mismo largo.
+  Expandir una capa es recorrerlos en orden, sin saltos por la memoria.
+*/
+struct CapaBFS {
+    vector<uint64_t> estados;  // tablero empaquetado (4 bits por ficha)
+    vector<uint8_t> huecos;    // posición del hueco
+    vector<uint32_t> padres;   // índice del padre en la capa anterior
+
+    size_t size() const { return estados.size(); }
+    size_t bytes() const {
+        return estados.capacity() * sizeof(uint64_t) + huecos.capacity() + padres.capacity() * sizeof(uint32_t);
+    }
+
+    bool escribir(FILE* f) const { return escribirArreglo(f, estados) && escribirArreglo(f, huecos) && escribirArreglo(f, padres); }
+    bool leer(LectorPunto& lector) {
+        return leerArreglo(lector, estados) && leerArreglo(lector, huecos) && leerArreglo(lector, padres) &&
+               huecos.size() == estados.size() && padres.size() == estados.size();
+    }
+};
+
+/*
+  TablaVisitados: conjunto de uint64_t con direccionamiento abierto (sondeo lineal) en un
+  solo arreglo. 0 marca casilla libre: ningún tablero empaquetado vale 0.
+  Se duplica al pasar de la mitad de ocupación.
+*/
+class TablaVisitados {
+public:
+    TablaVisitados() : casillas(1024, 0) {}
+
+    static uint64_t mezclar(uint64_t x) { // splitmix64
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    const uint64_t* direccion(uint64_t clave) const {
+        return &casillas[mezclar(clave) & (casillas.size() - 1)];
+    }
+
+    // true si la clave no estaba
+    bool insertar(uint64_t clave) {
+        if ((ocupadas + 1) * 2 > casillas.size()) crecer();
+        size_t mask = casillas.size() - 1;
+        for (size_t i = mezclar(clave) & mask;; i = (i + 1) & mask) {
+            if (casillas[i] == clave) return false;
+            if (casillas[i] == 0) { casillas[i] = clave; ++ocupadas; return true; }
+        }
+    }
+
+    bool contiene(uint64_t clave) const {
+        size_t mask = casillas.size() - 1;
+        for (size_t i = mezclar(clave) & mask;; i = (i + 1) & mask) {
+            if (casillas[i] == clave) return true;
+            if (casillas[i] == 0) return false;
+        }
+    }
+
+    size_t bytes() const { return casillas.capacity() * sizeof(uint64_t); }
+
+    // el arreglo tal cual (sin volver a insertar): cargarlo cuesta lo mismo que leer el archivo
+    bool escribir(FILE* f) const {
+        uint64_t o = ocupadas;
+        return fwrite(&o, sizeof(o), 1, f) == 1 && escribirArreglo(f, casillas);
+    }
+    bool leer(LectorPunto& lector) {
+        uint64_t o;
+        if (!lector.leer(&o, sizeof(o)) || !leerArreglo(lector, casillas)) return false;
+        ocupadas = (size_t)o;
+        // el tamaño tiene que ser potencia de 2 (la máscara del sondeo depende de eso)
+        return casillas.size() >= 2 && (casillas.size() & (casillas.size() - 1)) == 0 && ocupadas * 2 <= casillas.size();
+    }
+
+private:
+    vector<uint64_t> casillas;
+    size_t ocupadas = 0;
+
+    void crecer() {
+        vector<uint64_t> viejas(casillas.size() * 2, 0);
+        viejas.swap(casillas);
+        ocupadas = 0;
+        for (uint64_t c : viejas) if (c) insertar(c);
+    }
+};
+
+/*
+  Punto de control de bfsCapasSolve, tomado entre dos bloques de padres:
+    CabeceraPuntoBFS
+    capas completas  x capas   (CapaBFS::escribir)
+    capa en curso              (los hijos ya generados de la última capa completa)
+    visitados                  (TablaVisitados::escribir)
+  "base" es el primer padre de la última capa que falta expandir.
+*/
+const char MAGIA_PUNTO_BFS[4] = { 'N', 'P', 'Z', 'K' };
+const uint32_t VERSION_PUNTO_BFS = 1;
+
+#pragma pack(push, 1)
+struct CabeceraPuntoBFS {
+    char magia[4];
+    uint32_t version;
+    uint32_t n;
+    uint32_t capas;
+    uint64_t inicio;  // tablero inicial empaquetado: el punto solo sirve para ese tablero
+    uint64_t base;
+    uint64_t nodos;
+};
+#pragma pack(pop)
+
+bool guardarPuntoBFS(const string& ruta, int n, uint64_t inicio, const vector<CapaBFS>& capas,
+                     const CapaBFS& sig, size_t base, size_t nodos, const TablaVisitados& visitados)
+{
+    return escribirAtomico(ruta, [&](FILE* f) {
+        CabeceraPuntoBFS cab;
+        memcpy(cab.magia, MAGIA_PUNTO_BFS, 4);
+        cab.version = VERSION_PUNTO_BFS;
+        cab.n = (uint32_t)n;
+        cab.capas = (uint32_t)capas.size();
+        cab.inicio = inicio;
+        cab.base = base;
+        cab.nodos = nodos;
+        if (fwrite(&cab, sizeof(cab), 1, f) != 1) return false;
+        for (auto& c : capas) if (!c.escribir(f)) return false;
+        return sig.escribir(f) && visitados.escribir(f);
+    });
+}
+
+// false si no hay punto de control para este tablero (o no se pudo leer entero)
+bool cargarPuntoBFS(const string& ruta, int n, uint64_t inicio, vector<CapaBFS>& capas,
+                    CapaBFS& sig, size_t& base, size_t& nodos, TablaVisitados& visitados)
+{
+    LectorPunto lector(ruta);
+    CabeceraPuntoBFS cab;
+    if (!lector.leer(&cab, sizeof(cab))) return false;
+    if (memcmp(cab.magia, MAGIA_PUNTO_BFS, 4) != 0 || cab.version != VERSION_PUNTO_BFS ||
+        cab.n != (uint32_t)n || cab.inicio != inicio || cab.capas == 0)
+        return false;
+    vector<CapaBFS> leidas(cab.capas);
+    for (auto& c : leidas) if (!c.leer(lector)) return false;
+    CapaBFS enCurso;
+    TablaVisitados tabla;
+    if (!enCurso.leer(lector) || !tabla.leer(lector) || cab.base > leidas.back().size()) return false;
+    capas.swap(leidas);
+    sig = move(enCurso);
+    visitados = move(tabla);
+    base = (size_t)cab.base;
+    nodos = (size_t)cab.nodos;
+    return true;
+}
+
+/*
+  bfsCapasSolve: BFS por capas sobre CapaBFS + TablaVisitados (solo n <= 4).
+  Los hijos de cada bloque de padres se generan primero en un búfer pequeño y se hace
+  prefetch de su casilla en la tabla; después se insertan, cuando esas líneas ya llegaron.
+  Se guardan todas las capas (13 bytes por estado) para reconstruir el camino con "padres".
+    - agotado: queda en true si se pasó del presupuesto o del deadline.
+    - rutaPunto: si no está vacía, se sigue desde el punto de control de ese archivo (si es del
+      mismo tablero), se guarda uno nuevo cada SEGUNDOS_ENTRE_PUNTOS y otro al vencer el deadline.
+      Al terminar (con o sin solución) el archivo se borra.
+  Devuelve el mismo formato que bfsSolve.
+*/
+pair<bool, vector<string>> bfsCapasSolve(const vector<int>& start, int n, size_t memoryBudgetBytes,
+                                         chrono::steady_clock::time_point deadline, bool& agotado,
+                                         const string& rutaPunto = "")
+{
+    agotado = false;
+    vector<string> emptyRes;
+    int N = n * n;
+    if (n > 4) return { false, emptyRes };
+
+    vector<int> goalVec(N);
+    for (int i = 0; i < N - 1; ++i) goalVec[i] = i + 1;
+    goalVec[N - 1] = 0;
+    uint64_t objetivo = empaquetarTablero(goalVec);
+
+    int dr[4] = { -1, 1, 0, 0 };
+    int dc[4] = { 0, 0, -1, 1 };
+
+    vector<CapaBFS> capas(1);
+    CapaBFS sig;     // capa que se está generando
+    size_t base = 0; // primer padre de capas.back() que falta expandir
+    TablaVisitados visitados;
+    size_t nodes = 0;
+    RegistroNodos registro{ nodes };
+    uint64_t inicio = empaquetarTablero(start);
+    auto antesDeCargar = chrono::steady_clock::now();
+    if (!rutaPunto.empty() && cargarPuntoBFS(rutaPunto, n, inicio, capas, sig, base, nodes, visitados)) {
+        deadline += chrono::steady_clock::now() - antesDeCargar; // leer el archivo no cuenta como búsqueda
+    }
+    else {
+        capas[0].estados.push_back(inicio);
+        capas[0].huecos.push_back((uint8_t)(find(start.begin(), start.end(), 0) - start.begin()));
+        capas[0].padres.push_back(0);
+        visitados.insertar(inicio);
+    }
+
+    size_t bytesCapas = 0;
+    for (auto& c : capas) bytesCapas += c.bytes();
+    long long encontrado = (inicio == objetivo) ? 0 : -1; // índice en la última capa
+    auto ultimoPunto = chrono::steady_clock::now();
+
+    const size_t BLOQUE = 64;
+    struct Candidato { uint64_t estado; uint8_t hueco; uint32_t padre; };
+    vector<Candidato> buf;
+    buf.reserve(BLOQUE * 4);
+
+    while (encontrado < 0 && capas.back().size() > 0) {
+        const CapaBFS& cur = capas.back();
+        for (; base < cur.size() && encontrado < 0; base += BLOQUE) {
+            if ((nodes += BLOQUE) % CLOCK_CADA_NODOS < BLOQUE) {
+                auto ahora = chrono::steady_clock::now();
+                if (ahora > deadline) {
+                    agotado = true;
+                    if (!rutaPunto.empty()) guardarPuntoBFS(rutaPunto, n, inicio, capas, sig, base, nodes, visitados);
+                    return { false, emptyRes };
+                }
+                if (!rutaPunto.empty() && ahora - ultimoPunto > chrono::seconds(SEGUNDOS_ENTRE_PUNTOS)) {
+                    guardarPuntoBFS(rutaPunto, n, inicio, capas, sig, base, nodes, visitados);
+                    ultimoPunto = chrono::steady_clock::now(); // sin contar lo que tardó en escribirse
+                }
+            }
+            if (bytesCapas + sig.bytes() + visitados.bytes() > memoryBudgetBytes) {
+                agotado = true;
+                if (!rutaPunto.empty()) remove(rutaPunto.c_str()); // con este presupuesto no va a terminar
+                return { false, emptyRes };
+            }
+
+            // fase 1: generar hijos del bloque y adelantar la lectura de su casilla
+            buf.clear();
+            size_t fin = min(cur.size(), base + BLOQUE);
+            for (size_t i = base; i < fin; ++i) {
+                uint64_t s = cur.estados[i];
+                int zero = cur.huecos[i];
+                for (int k = 0; k < 4; ++k) {
+                    int nr = zero / n + dr[k], nc = zero % n + dc[k];
+                    if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
+                    int nz = nr * n + nc;
+                    uint64_t v = (s >> (4 * nz)) & 0xF;
+                    uint64_t hijo = (s & ~((uint64_t)0xF << (4 * nz))) | (v << (4 * zero));
+                    PREFETCH(visitados.direccion(hijo));
+                    buf.push_back({ hijo, (uint8_t)nz, (uint32_t)i });
+                }
+            }
+
+            // fase 2: insertar en visitados y en la capa siguiente
+            for (auto& c : buf) {
+                if (!visitados.insertar(c.estado)) continue;
+                sig.estados.push_back(c.estado);
+                sig.huecos.push_back(c.hueco);
+                sig.padres.push_back(c.padre);
+                if (c.estado == objetivo) { encontrado = (long long)sig.size() - 1; break; }
+            }
+        }
+        bytesCapas += sig.bytes();
+        capas.push_back(move(sig));
+        sig = CapaBFS();
+        base = 0;
+    }
+    if (!rutaPunto.empty()) remove(rutaPunto.c_str());
+    if (encontrado < 0) return { false, emptyRes };
+
+    // reconstruir: desde la última capa seguir los índices de padre hasta la capa 0
+    vector<string> path(capas.size());
+    size_t idx = (size_t)encontrado;
+    for (size_t d = capas.size(); d-- > 0;) {
+        path[d] = boardToKey(desempaquetarTablero(capas[d].estados[idx], N));
+        idx = capas[d].padres[idx];
+    }
+    return { true, path };
+}
+
+/* ---------------------- BFS con detección de duplicados diferida (ordenando capas) ---------------------- */
+
+/*
+  Hijo generado durante una capa: tablero empaquetado, hueco y padre en la capa anterior.
+*/
+struct HijoBFS {
+    uint64_t estado;
+    uint32_t padre;
+    uint8_t hueco;
+};
+
+/*
+  Ordenamiento radix LSD por "estado", 8 bits por pasada. Las pasadas en las que todos
+  los elementos tienen el mismo byte se saltan (un 3x3 empaquetado usa solo 36 bits).
+*/
+void ordenarRadix(vector<HijoBFS>& v, vector<HijoBFS>& aux) {
+    aux.resize(v.size());
+    for (int byte = 0; byte < 8; ++byte) {
+        size_t cuenta[257] = { 0 };
+        int desp = 8 * byte;
+        for (auto& h : v) cuenta[((h.estado >> desp) & 0xFF) + 1]++;
+        bool saltar = false;
+        for (int b = 1; b <= 256; ++b) if (cuenta[b] == v.size()) { saltar = true; break; }
+        if (saltar) continue;
+        for (int b = 0; b < 256; ++b) cuenta[b + 1] += cuenta[b];
+        for (auto& h : v) aux[cuenta[(h.estado >> desp) & 0xFF]++] = h;
+        v.swap(aux);
+    }
+}
+
+/*
+  bfsOrdenadoSolve: BFS sin tabla hash de visitados (solo n <= 4).
+  Por cada capa:
+    1) se generan TODOS los hijos en un búfer plano (recorrido secuencial de la capa),
+    2) se ordenan por el tablero empaquetado con ordenarRadix,
+    3) se eliminan repetidos en una pasada (quedan contiguos),
+    4) se restan las dos capas anteriores (también ordenadas) mezclando como en merge sort.
+  Todo son pasadas secuenciales en vez de sondeos aleatorios a una tabla hash.
+  Las capas quedan guardadas (ordenadas) para reconstruir el camino con los índices de padre.
+    - agotado: queda en true si se pasó del presupuesto o del deadline.
+  Devuelve el mismo formato que bfsSolve.
+*/
+pair<bool, vector<string>> bfsOrdenadoSolve(const vector<int>& start, int n, size_t memoryBudgetBytes,
+                                            chrono::steady_clock::time_point deadline, bool& agotado)
+{
+    agotado = false;
+    vector<string> emptyRes;
+    int N = n * n;
+    if (n > 4) return { false, emptyRes };
+
+    vector<int> goalVec(N);
+    for (int i = 0; i < N - 1; ++i) goalVec[i] = i + 1;
+    goalVec[N - 1] = 0;
+    uint64_t objetivo = empaquetarTablero(goalVec);
+
+    int dr[4] = { -1, 1, 0, 0 };
+    int dc[4] = { 0, 0, -1, 1 };
+
+    vector<CapaBFS> capas(1);
+    capas[0].estados.push_back(empaquetarTablero(start));
+    capas[0].huecos.push_back((uint8_t)(find(start.begin(), start.end(), 0) - start.begin()));
+    capas[0].padres.push_back(0);
+
+    // true si "estado" está en la capa ordenada, avanzando el cursor "pos" (merge)
+    auto estaEn = [](const CapaBFS& capa, size_t& pos, uint64_t estado) {
+        while (pos < capa.size() && capa.estados[pos] < estado) ++pos;
+        return pos < capa.size() && capa.estados[pos] == estado;
+    };
+
+    size_t bytesCapas = capas[0].bytes();
+    long long encontrado = (capas[0].estados[0] == objetivo) ? 0 : -1;
+    vector<HijoBFS> hijos, aux;
+    size_t nodes = 0;
+    RegistroNodos registro{ nodes };
+
+    while (encontrado < 0 && capas.back().size() > 0) {
+        if (chrono::steady_clock::now() > deadline) { agotado = true; return { false, emptyRes }; }
+
+        // 1) generar todos los hijos
+        const CapaBFS& cur = capas.back();
+        nodes += cur.size();
+        hijos.clear();
+        for (size_t i = 0; i < cur.size(); ++i) {
+            uint64_t s = cur.estados[i];
+            int zero = cur.huecos[i];
+            for (int k = 0; k < 4; ++k) {
+                int nr = zero / n + dr[k], nc = zero % n + dc[k];
+                if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
+                int nz = nr * n + nc;
+                uint64_t v = (s >> (4 * nz)) & 0xF;
+                hijos.push_back({ (s & ~((uint64_t)0xF << (4 * nz))) | (v << (4 * zero)), (uint32_t)i, (uint8_t)nz });
+            }
+        }
+        size_t bytesBufer = (hijos.capacity() + aux.capacity()) * sizeof(HijoBFS);
+        if (bytesCapas + bytesBufer > memoryBudgetBytes) { agotado = true; return { false, emptyRes }; }
+
+        // 2) ordenar
+        ordenarRadix(hijos, aux);
+
+        // 3) y 4) quitar repetidos y restar las dos capas anteriores
+        const CapaBFS* previa = capas.size() >= 2 ? &capas[capas.size() - 2] : nullptr;
+        size_t posCur = 0, posPrevia = 0;
+        CapaBFS sig;
+        for (size_t i = 0; i < hijos.size(); ++i) {
+            uint64_t e = hijos[i].estado;
+            if (i > 0 && hijos[i - 1].estado == e) continue;
+            if (estaEn(cur, posCur, e)) continue;
+            if (previa && estaEn(*previa, posPrevia, e)) continue;
+            sig.estados.push_back(e);
+            sig.huecos.push_back(hijos[i].hueco);
+            sig.padres.push_back(hijos[i].padre);
+            if (e == objetivo) encontrado = (long long)sig.size() - 1;
+        }
+        bytesCapas += sig.bytes();
+        capas.push_back(move(sig));
+    }
+    if (encontrado < 0) return { false, emptyRes };
+
+    vector<string> path(capas.size());
+    size_t idx = (size_t)encontrado;
+    for (size_t d = capas.size(); d-- > 0;) {
+        path[d] = boardToKey(desempaquetarTablero(capas[d].estados[idx], N));
+        idx = capas[d].padres[idx];
+    }
+    return { true, path };
+}
+
+/* ---------------------- BFS (cola FIFO) que devuelve la secuencia de estados ---------------------- */
+
+/*
+  bfsSolve:
+    - start: estado inicial (vector<int> tamaño n*n)
+    - n: dimensión
+    - memoryBudgetBytes: presupuesto de memoria en bytes (visited + parent + moveTaken + cola)
+    - timeLimitSeconds: límite de tiempo en segundos (seguridad)
+    - degradeToIDA: si se agota el presupuesto, seguir con IDA* en vez de fallar
+  Devuelve: pair<bool, vector<string>>
+    - first = true si se encontró solución
+    - second = secuencia de claves (keys) desde inicio hasta objetivo (incluyendo ambos)
+*/
+
+
+// ❤️ ❤️ ❤️ APLICAMOS BFS CON COLA 
+
+/*
+  bfsSolve:
+    - start: tablero inicial (vector<int> de tamaño n*n)
+    - n: dimensión del puzzle
+    - memoryBudgetBytes: presupuesto de memoria en bytes (lo que realmente se agota es la RAM)
+    - timeLimitSeconds: límite de tiempo en segundos (seguridad)
+    - degradeToIDA: true = al llegar al presupuesto se cambia a IDA* (memoria O(profundidad))
+    - pdb: base de patrones para el IDA* de respaldo (nullptr = manhattan + conflictos lineales)
+    - wd: walking distance para el IDA* de respaldo (opcional, se toma el máximo con la anterior)
+    - rutaPunto: archivo de punto de control para reanudar (solo n <= 4, ver bfsCapasSolve)
+  Para n <= 4 la frontera va en arreglos contiguos (bfsCapasSolve); para n mayores se usa la cola.
+  Devuelve: pair<bool, vector<string>>
+    - first = true si se encontró solución
+    - second = vector de strings con la secuencia de tableros desde inicio hasta objetivo
+*/
+
+// nuestra funcion bfsSolve devuelve 2 cosas
+// un bool para si encontro o no la solucion
+// un vector lista de strings que representa la secuencia de tableros desde el estado inicial hasta el objetivo.
+// Cada string se obtiene con la función boardToKey, que convierte un tablero en un string del tipo "1,2,3,0,4".
+// Así podemos reconstruir todos los pasos que BFS encontró para llegar a la solución.
+pair<bool, vector<string>> bfsSolve(const vector<int>& start, int n, size_t memoryBudgetBytes = (size_t)256 << 20,
+                                    int timeLimitSeconds = 30, bool degradeToIDA = true,
+                                    const BasePatrones* pdb = nullptr, const DistanciaCaminata* wd = nullptr,
+                                    const string& rutaPunto = "") 
+{
+    vector<string> emptyRes; // resultado vacío para devolver si no hay solución
+
+    int N = n * n;
+    auto t0 = chrono::steady_clock::now(); // tiempo inicial
+    auto deadline = t0 + chrono::seconds(timeLimitSeconds);
+
+    // ---------------- Construir tablero objetivo ----------------
+    vector<int> goalVec(N);
+    for (int i = 0; i < N - 1; ++i) goalVec[i] = i + 1; // números 1..N-1
+    goalVec[N - 1] = 0; // hueco al final
+    string goalKey = boardToKey(goalVec); // clave string del objetivo
+    string startKey = boardToKey(start);  // clave string del tablero inicial
+
+    if (startKey == goalKey) { // si ya está resuelto
+        return { true, vector<string>{startKey} };
+    }
+
+    // ---------------- n <= 4: frontera en arreglos contiguos ----------------
+    if (n <= 4) {
+        bool agotado;
+        auto res = bfsCapasSolve(start, n, memoryBudgetBytes, deadline, agotado, rutaPunto);
+        if (res.first || !agotado) return res;
+        if (!degradeToIDA || chrono::steady_clock::now() > deadline) return { false, emptyRes };
+        return idaSolve(start, n, deadline, pdb, wd, perimetroPara(n)); // se agotó el presupuesto de memoria
+    }
+
+    // ---------------- Inicializar estructuras BFS ----------------
+    queue<vector<int>> q;            // CREACION de cola FIFO de tableros por explorar
+    unordered_set<string> visited;   // conjunto de tableros ya visitados
+    unordered_map<string, string> parent;   // mapa de padres para reconstruir camino
+    unordered_map<string, char> moveTaken; // movimiento que generó cada tablero
+
+    PresupuestoMemoria presupuesto;
+    presupuesto.limiteBytes = memoryBudgetBytes;
+    const size_t bytesTableroEnCola = sizeof(vector<int>) + N * sizeof(int) + CABECERA_MALLOC;
+
+    // bytes de un estado nuevo en visited + parent + moveTaken
+    auto bytesEstado = [&](const string& key, const string& padre) {
+        size_t heapKey = bytesHeapString(key);
+        return bytesNodoHash(sizeof(string)) + heapKey
+             + bytesNodoHash(2 * sizeof(string)) + heapKey + bytesHeapString(padre)
+             + bytesNodoHash(sizeof(string) + sizeof(char)) + heapKey;
+    };
+
+    q.push(start);         // agregar tablero inicial a la cola
+    visited.insert(startKey); // marcar como visitado
+    parent[startKey] = "";    // raíz no tiene padre
+    presupuesto.usados += bytesEstado(startKey, "") + bytesTableroEnCola;
+
+    // ---------------- Definir movimientos posibles ----------------
+    int dr[4] = { -1, 1, 0, 0 }; // cambio de fila para U,D,L,R
+    int dc[4] = { 0, 0, -1, 1 }; // cambio de columna para U,D,L,R
+    char mc[4] = { 'U','D','L','R' }; // representación del movimiento
+
+    size_t nodes = 0;  // contador de nodos explorados
+    RegistroNodos registro{ nodes };
+
+    // ---------------- Bucle principal BFS ----------------
+    while (!q.empty()) {
+        // ---------- Límites de seguridad ----------
+        // el reloj se lee cada CLOCK_CADA_NODOS nodos (leerlo siempre cuesta más que expandir)
+        if (nodes % CLOCK_CADA_NODOS == 0 && chrono::steady_clock::now() > deadline)
+            return { false, emptyRes }; // timeout
+
+        // presupuesto de memoria agotado: liberar todo y seguir con IDA* (o fallar)
+        size_t cubetas = bytesCubetas(visited) + bytesCubetas(parent) + bytesCubetas(moveTaken);
+        if (presupuesto.excedido(cubetas)) {
+            if (!degradeToIDA) return { false, emptyRes };
+            queue<vector<int>>().swap(q);
+            unordered_set<string>().swap(visited);
+            unordered_map<string, string>().swap(parent);
+            unordered_map<string, char>().swap(moveTaken);
+            return idaSolve(start, n, deadline, pdb, wd, perimetroPara(n));
+        }
+
+        // ---------- Tomar tablero actual ----------
+        vector<int> cur = move(q.front()); q.pop(); // sacar de la cola
+        presupuesto.usados -= bytesTableroEnCola;
+        ++nodes;                               // contar nodo explorado
+        string curKey = boardToKey(cur);       // clave string
+
+        // ---------- Ubicar el hueco ----------
+        int zero = -1;
+        for (int i = 0; i < N; ++i) if (cur[i] == 0) { zero = i; break; }
+        int zr = zero / n;  // fila del hueco
+        int zc = zero % n;  // columna del hueco
+
+        // ---------- Generar tableros hijos ----------
+        for (int k = 0; k < 4; ++k) {
+            int nr = zr + dr[k];  // nueva fila tras movimiento
+            int nc = zc + dc[k];  // nueva columna tras movimiento
+            if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue; // fuera del tablero
+
+            vector<int> nxt = cur;
+            swap(nxt[zero], nxt[nr * n + nc]); // mover hueco
+            string nxtKey = boardToKey(nxt); // clave del tablero hijo
+
+            // ---------- Revisar si ya fue visitado ----------
+            if (visited.find(nxtKey) != visited.end()) continue; // ya visto
+            visited.insert(nxtKey);      // marcar visitado
+            parent[nxtKey] = curKey;     // guardar padre
+            moveTaken[nxtKey] = mc[k];   // guardar movimiento
+            presupuesto.usados += bytesEstado(nxtKey, curKey);
+
+            // ---------- Comprobar si llegamos al objetivo ----------
+            if (nxtKey == goalKey) {
+                vector<string> path;
+                string curk = nxtKey;
+                while (!curk.empty()) {   // reconstruir camino desde objetivo hasta inicio
+                    path.push_back(curk);
+                    curk = parent[curk];
+                }
+                reverse(path.begin(), path.end()); // ordenar de inicio a objetivo
+                return { true, path };              // devolver solución
+            }
+
+            // ---------- Agregar tablero hijo a la cola ----------
+            q.push(move(nxt)); // se explorará más adelante
+            presupuesto.usados += bytesTableroEnCola;
+        }
+    }
+
+    // si la cola se vacía y no encontramos solución
+    return { false, emptyRes };
+}
+
+
+/* ---------------------- BFS de frontera (solo dos capas) ---------------------- */
+
+/*
+  Búsqueda de frontera: BFS que no guarda visited ni parent. Solo existen la capa actual
+  y la siguiente, y cada estado lleva los bits de los operadores ya usados (los movimientos
+  que vuelven a su capa anterior), que no se vuelven a generar. Como el grafo del puzzle es
+  bipartito (cada movimiento cambia la paridad de la posición del hueco), los vecinos de
+  la capa d están solo en d-1 o d+1, así que esos bits bastan para no retroceder.
+  La memoria crece con el ancho de la frontera, no con la cantidad total de estados.
+
+  El camino se recupera por divide y vencerás: una segunda búsqueda marca cada estado de la
+  capa media y propaga la marca a sus descendientes; al llegar al destino se conoce un
+  estado medio del camino óptimo y se resuelven recursivamente las dos mitades.
+*/
+struct BusquedaFrontera {
+    int n = 0, N = 0;
+    size_t presupuesto = 0;
+    chrono::steady_clock::time_point deadline;
+    size_t nodes = 0;
+    bool agotado = false;  // timeout o presupuesto
+
+    struct Entrada {
+        uint8_t usados;    // bit k = el movimiento k lleva a la capa anterior
+        uint64_t medio;    // estado de la capa media del que desciende (si se pidió)
+    };
+
+    // Distancia de origen a destino (-1 si no hay o se agotó). Si capaMedia >= 0 deja en
+    // *medio un estado de esa capa que está en un camino óptimo.
+    int distancia(uint64_t origen, uint64_t destino, int capaMedia, uint64_t* medio) {
+        if (origen == destino) { if (medio) *medio = origen; return 0; }
+        int dr[4] = { -1, 1, 0, 0 };
+        int dc[4] = { 0, 0, -1, 1 };
+        const size_t bytesEntrada = bytesNodoHash(sizeof(uint64_t) + sizeof(Entrada));
+
+        unordered_map<uint64_t, Entrada> capa, siguiente;
+        capa[origen] = { 0, origen };
+        for (int d = 1; !capa.empty(); ++d) {
+            siguiente.clear();
+            for (auto& kv : capa) {
+                if (++nodes % CLOCK_CADA_NODOS == 0 && chrono::steady_clock::now() > deadline) agotado = true;
+                size_t bytes = (capa.size() + siguiente.size()) * bytesEntrada + bytesCubetas(capa) + bytesCubetas(siguiente);
+                if (bytes > presupuesto) agotado = true;
+                if (agotado) return -1;
+
+                uint64_t s = kv.first;
+                int zero = 0;
+                while (((s >> (4 * zero)) & 0xF) != 0) ++zero;
+                for (int k = 0; k < 4; ++k) {
+                    if (kv.second.usados & (1 << k)) continue; // volvería a la capa anterior
+                    int nr = zero / n + dr[k], nc = zero % n + dc[k];
+                    if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
+                    int nz = nr * n + nc;
+                    uint64_t v = (s >> (4 * nz)) & 0xF;
+                    uint64_t hijo = (s & ~((uint64_t)0xF << (4 * nz))) | (v << (4 * zero));
+
+                    uint64_t marca = (d == capaMedia) ? hijo : kv.second.medio;
+                    auto ins = siguiente.insert({ hijo, { 0, marca } });
+                    ins.first->second.usados |= (uint8_t)(1 << (k ^ 1)); // k^1 = movimiento inverso
+                    if (hijo == destino) {
+                        if (medio) *medio = ins.first->second.medio;
+                        return d;
+                    }
+                }
+            }
+            capa.swap(siguiente);
+        }
+        return -1;
+    }
+
+    // Agrega a "camino" los estados de a (excluido) a b (incluido), sabiendo que están a distancia d.
+    bool reconstruir(uint64_t a, uint64_t b, int d, vector<uint64_t>& camino) {
+        if (d == 0) return true;
+        if (d == 1) { camino.push_back(b); return true; }
+        int m = d / 2;
+        uint64_t medio = 0;
+        if (distancia(a, b, m, &medio) != d) return false;
+        return reconstruir(a, medio, m, camino) && reconstruir(medio, b, d - m, camino);
+    }
+};
+
+/*
+  bfsFronteraSolve: BFS óptimo como bfsSolve pero con memoria proporcional a la frontera.
+    - solo n <= 4 (tableros empaquetados en 64 bits)
+    - memoryBudgetBytes / timeLimitSeconds: mismos límites que bfsSolve
+    - objetivo: tablero de destino (vacío = 1..N-1,0); no necesita el hueco en una esquina
+  Devuelve el mismo formato que bfsSolve.
+*/
+pair<bool, vector<string>> bfsFronteraSolve(const vector<int>& start, int n, size_t memoryBudgetBytes = (size_t)256 << 20,
+                                            int timeLimitSeconds = 30, const vector<int>& objetivo = {})
+{
+    vector<string> emptyRes;
+    int N = n * n;
+    vector<int> goalVec = objetivo;
+    if (goalVec.empty()) {
+        goalVec.resize(N);
+        for (int i = 0; i < N - 1; ++i) goalVec[i] = i + 1;
+        goalVec[N - 1] = 0;
+    }
+    // se llega de uno a otro si los dos están (o no) en la clase del objetivo de siempre
+    if (n > 4 || isSolvable(start, n) != isSolvable(goalVec, n)) return { false, emptyRes };
+
+    BusquedaFrontera bf;
+    bf.n = n;
+    bf.N = N;
+    bf.presupuesto = memoryBudgetBytes;
+    bf.deadline = chrono::steady_clock::now() + chrono::seconds(timeLimitSeconds);
+    RegistroNodos registro{ bf.nodes };
+
+    uint64_t origen = empaquetarTablero(start), destino = empaquetarTablero(goalVec);
+    int d = bf.distancia(origen, destino, -1, nullptr);
+    if (d < 0) return { false, emptyRes };
+
+    vector<uint64_t> camino{ origen };
+    if (!bf.reconstruir(origen, destino, d, camino)) return { false, emptyRes };
+
+    vector<string> path;
+    for (uint64_t s : camino) path.push_back(boardToKey(desempaquetarTablero(s, N)));
+    return { true, path };
+}
+
+/* ---------------------- Formato binario de tableros y soluciones ---------------------- */
+
+/*
+  Archivo binario versionado (extensión sugerida .npz) pensado para mapearse en memoria
+  y leerse sin parsear nada. Todo en little-endian, en este orden:
+
+    CabeceraArchivo                      (tamaño fijo)
+    EntradaIndice   x cantidad           (una por instancia, tamaño fijo)
+    tableros        x cantidad           (N fichas little-endian de bytesPorFichaPara(N) bytes: 1, 2 o 4)
+    movimientos                          (2 bits por movimiento: U=0, D=1, L=2, R=3, 4 por byte)
+
+  Cada EntradaIndice guarda la semilla con la que se generó el tablero, dónde empiezan sus
+  movimientos y las estadísticas del solve. El tablero i está en offsetTableros + i * bytesTablero.
+  La exportación/importación de texto conserva el formato de siempre (boardToKey).
+*/
+const char MAGIA_NPZ[4] = { 'N', 'P', 'Z', 'B' };
+const uint32_t VERSION_NPZ = 1;
+
+#pragma pack(push, 1)
+struct CabeceraArchivo {
+    char magia[4];
+    uint32_t version;
+    uint32_t n;              // dimensión del tablero
+    uint32_t bytesPorFicha;  // bytesPorFichaPara(n * n): 1, 2 o 4
+    uint64_t cantidad;       // instancias guardadas
+    uint64_t offsetIndice;
+    uint64_t offsetTableros;
+    uint64_t offsetMovimientos;
+    uint64_t bytesMovimientos;
+};
+
+struct EstadisticasSolve {
+    uint64_t nodos = 0;         // nodos expandidos
+    uint64_t microsegundos = 0; // tiempo del solve
+    uint32_t resuelto = 0;      // 1 si se encontró solución
+    uint32_t reservado = 0;
+};
+
+struct EntradaIndice {
+    uint64_t semilla;
+    uint64_t offsetMovs;   // en bytes, relativo a offsetMovimientos
+    uint32_t numMovs;      // cantidad de movimientos de la solución (0 si no hay)
+    uint32_t reservado;
+    EstadisticasSolve stats;
+};
+#pragma pack(pop)
+
+// Una instancia en memoria: tablero + semilla + solución + estadísticas
+struct InstanciaPuzzle {
+    vector<int> tablero;
+    uint64_t semilla = 0;
+    string movimientos;    // 'U','D','L','R' (mismo significado que EstadoTablero::applyMove)
+    EstadisticasSolve stats;
+};
+
+const char LETRA_MOV[4] = { 'U', 'D', 'L', 'R' };
+
+int codigoMovimiento(char m) {
+    switch (m) {
+    case 'U': return 0;
+    case 'D': return 1;
+    case 'L': return 2;
+    case 'R': return 3;
+    }
+    return -1;
+}
+
+/*
+  Convierte la secuencia de claves que devuelve bfsSolve en movimientos del hueco,
+  comparando la posición del 0 entre estados consecutivos.
+*/
+string movimientosDesdeClaves(const vector<string>& path, int n) {
+    string movs;
+    int zPrev = -1;
+    for (auto& key : path) {
+        vector<int> b = keyToBoard(key);
+        int z = int(find(b.begin(), b.end(), 0) - b.begin());
+        if (zPrev >= 0) {
+            if (z == zPrev - n) movs += 'U';
+            else if (z == zPrev + n) movs += 'D';
+            else if (z == zPrev - 1) movs += 'L';
+            else movs += 'R';
+        }
+        zPrev = z;
+    }
+    return movs;
+}
+
+// bytes por ficha para tableros de N casillas: el menor ancho donde entra N - 1
+uint32_t bytesPorFichaPara(uint64_t N) {
+    return (N <= 0x100) ? 1 : (N <= 0x10000) ? 2 : 4;
+}
+
+/*
+  Escribe las instancias en formato binario. Todas deben ser del mismo n.
+  Devuelve false si no se pudo abrir o escribir el archivo.
+*/
+bool escribirArchivoBinario(const string& ruta, int n, const vector<InstanciaPuzzle>& instancias) {
+    uint64_t N = (uint64_t)n * n;
+    uint32_t bytesPorFicha = bytesPorFichaPara(N);
+    uint64_t bytesTablero = N * bytesPorFicha;
+
+    CabeceraArchivo cab;
+    memcpy(cab.magia, MAGIA_NPZ, 4);
+    cab.version = VERSION_NPZ;
+    cab.n = (uint32_t)n;
+    cab.bytesPorFicha = bytesPorFicha;
+    cab.cantidad = instancias.size();
+    cab.offsetIndice = sizeof(CabeceraArchivo);
+    cab.offsetTableros = cab.offsetIndice + cab.cantidad * sizeof(EntradaIndice);
+    cab.offsetMovimientos = cab.offsetTableros + cab.cantidad * bytesTablero;
+
+    // índice + movimientos empaquetados
+    vector<EntradaIndice> indice(instancias.size());
+    vector<uint8_t> movs;
+    for (size_t i = 0; i < instancias.size(); ++i) {
+        const InstanciaPuzzle& ins = instancias[i];
+        if (ins.tablero.size() != N) return false;
+        EntradaIndice& e = indice[i];
+        e.semilla = ins.semilla;
+        e.offsetMovs = movs.size();
+        e.numMovs = (uint32_t)ins.movimientos.size();
+        e.reservado = 0;
+        e.stats = ins.stats;
+        for (size_t k = 0; k < ins.movimientos.size(); k += 4) {
+            uint8_t byte = 0;
+            for (size_t j = 0; j < 4 && k + j < ins.movimientos.size(); ++j) {
+                int c = codigoMovimiento(ins.movimientos[k + j]);
+                if (c < 0) return false;
+                byte |= (uint8_t)(c << (2 * j));
+            }
+            movs.push_back(byte);
+        }
+    }
+    cab.bytesMovimientos = movs.size();
+
+    ofstream out(ruta, ios::binary | ios::trunc);
+    if (!out) return false;
+    out.write((const char*)&cab, sizeof(cab));
+    if (!indice.empty()) out.write((const char*)indice.data(), indice.size() * sizeof(EntradaIndice));
+
+    vector<uint8_t> buf(bytesTablero);
+    for (auto& ins : instancias) {
+        for (uint64_t k = 0; k < N; ++k)
+            for (uint32_t j = 0; j < bytesPorFicha; ++j)
+                buf[k * bytesPorFicha + j] = (uint8_t)((uint32_t)ins.tablero[k] >> (8 * j));
+        out.write((const char*)buf.data(), buf.size());
+    }
+    if (!movs.empty()) out.write((const char*)movs.data(), movs.size());
+    return (bool)out;
+}
+
+/*
+  ArchivoPuzzlesMapeado: abre un archivo .npz mapeándolo en memoria (mmap / MapViewOfFile).
+  Las consultas apuntan directo al archivo mapeado; no se copia ni se parsea nada.
+  La cabecera se lee y se valida antes de mapear (las tres zonas tienen que caber en el
+  archivo), y cada consulta revisa su índice y los límites de sus movimientos: un archivo
+  truncado o corrupto da consultas vacías, nunca lecturas fuera del mapeo.
+*/
+class ArchivoPuzzlesMapeado {
+public:
+    ArchivoPuzzlesMapeado() {}
+    ArchivoPuzzlesMapeado(const ArchivoPuzzlesMapeado&) = delete;
+    ArchivoPuzzlesMapeado& operator=(const ArchivoPuzzlesMapeado&) = delete;
+    ~ArchivoPuzzlesMapeado() { cerrar(); }
+
+    // Devuelve false si el archivo no existe, no es .npz, es de otra versión o la cabecera
+    // no cuadra con el tamaño del archivo.
+    bool abrir(const string& ruta) {
+        cerrar();
+#ifdef _WIN32
+        hArchivo = CreateFileA(ruta.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (hArchivo == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER tam;
+        DWORD leidos = 0;
+        if (!GetFileSizeEx(hArchivo, &tam) ||
+            !ReadFile(hArchivo, &cab, sizeof(cab), &leidos, NULL) || leidos != sizeof(cab) ||
+            !cabeceraValida(cab, (uint64_t)tam.QuadPart)) {
+            cerrar();
+            return false;
+        }
+        tamano = (size_t)tam.QuadPart;
+        hMapeo = CreateFileMappingA(hArchivo, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!hMapeo) { cerrar(); return false; }
+        datos = (const uint8_t*)MapViewOfFile(hMapeo, FILE_MAP_READ, 0, 0, 0);
+        if (!datos) { cerrar(); return false; }
+#else
+        fd = open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || pread(fd, &cab, sizeof(cab), 0) != (ssize_t)sizeof(cab) ||
+            !cabeceraValida(cab, (uint64_t)st.st_size)) {
+            cerrar();
+            return false;
+        }
+        tamano = (size_t)st.st_size;
+        void* p = mmap(nullptr, tamano, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) { cerrar(); return false; }
+        datos = (const uint8_t*)p;
+#endif
+        return true;
+    }
+
+    void cerrar() {
+#ifdef _WIN32
+        if (datos) UnmapViewOfFile(datos);
+        if (hMapeo) CloseHandle(hMapeo);
+        if (hArchivo != INVALID_HANDLE_VALUE) CloseHandle(hArchivo);
+        hMapeo = NULL;
+        hArchivo = INVALID_HANDLE_VALUE;
+#else
+        if (datos) munmap((void*)datos, tamano);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        datos = nullptr;
+        cab = CabeceraArchivo{};
+        tamano = 0;
+    }
+
+    int n() const { return datos ? (int)cab.n : 0; }
+    size_t cantidad() const { return datos ? (size_t)cab.cantidad : 0; }
+
+    // nullptr si i está fuera de rango
+    const EntradaIndice* entrada(size_t i) const {
+        if (i >= cantidad()) return nullptr;
+        return (const EntradaIndice*)(datos + cab.offsetIndice) + i;
+    }
+
+    // Bytes crudos del tablero i (cab.bytesPorFicha bytes por ficha); nullptr si i está fuera de rango
+    const uint8_t* tableroCrudo(size_t i) const {
+        if (i >= cantidad()) return nullptr;
+        return datos + cab.offsetTableros + i * bytesTablero(cab);
+    }
+
+    // vacío si i está fuera de rango
+    vector<int> tablero(size_t i) const {
+        const uint8_t* p = tableroCrudo(i);
+        if (!p) return {};
+        size_t N = (size_t)cab.n * cab.n;
+        vector<int> b(N);
+        for (size_t k = 0; k < N; ++k) {
+            uint32_t v = 0;
+            for (uint32_t j = 0; j < cab.bytesPorFicha; ++j) v |= (uint32_t)p[k * cab.bytesPorFicha + j] << (8 * j);
+            b[k] = (int)v;
+        }
+        return b;
+    }
+
+    // vacío si i está fuera de rango o sus movimientos se salen de la zona de movimientos
+    string movimientos(size_t i) const {
+        const EntradaIndice* e = entrada(i);
+        if (!e) return string();
+        uint64_t bytes = ((uint64_t)e->numMovs + 3) / 4;
+        if (e->offsetMovs > cab.bytesMovimientos || bytes > cab.bytesMovimientos - e->offsetMovs) return string();
+        const uint8_t* p = datos + cab.offsetMovimientos + e->offsetMovs;
+        string movs(e->numMovs, ' ');
+        for (uint32_t k = 0; k < e->numMovs; ++k)
+            movs[k] = LETRA_MOV[(p[k / 4] >> (2 * (k % 4))) & 3];
+        return movs;
+    }
+
+private:
+    const uint8_t* datos = nullptr;
+    CabeceraArchivo cab{};  // copia validada de la cabecera
+    size_t tamano = 0;
+
+    static uint64_t bytesTablero(const CabeceraArchivo& c) { return (uint64_t)c.n * c.n * c.bytesPorFicha; }
+
+    // la zona [offset, offset + cantidad * tamElemento) entra en un archivo de "tamano" bytes
+    static bool zonaCabe(uint64_t offset, uint64_t cantidad, uint64_t tamElemento, uint64_t tamano) {
+        if (offset > tamano) return false;
+        return tamElemento == 0 || cantidad <= (tamano - offset) / tamElemento;
+    }
+
+    static bool cabeceraValida(const CabeceraArchivo& c, uint64_t tamano) {
+        return memcmp(c.magia, MAGIA_NPZ, 4) == 0 && c.version == VERSION_NPZ &&
+               c.n >= 2 && c.n <= 0xFFFF && c.bytesPorFicha == bytesPorFichaPara((uint64_t)c.n * c.n) &&
+               zonaCabe(c.offsetIndice, c.cantidad, sizeof(EntradaIndice), tamano) &&
+               zonaCabe(c.offsetTableros, c.cantidad, bytesTablero(c), tamano) &&
+               zonaCabe(c.offsetMovimientos, c.bytesMovimientos, 1, tamano);
+    }
+#ifdef _WIN32
+    HANDLE hArchivo = INVALID_HANDLE_VALUE;
+    HANDLE hMapeo = NULL;
+#else
+    int fd = -1;
+#endif
+};
+
+/*
+  Exportación de texto: una línea por instancia con el formato de siempre
+    semilla;1,2,3,...,0;UDLR...
+  (la parte de movimientos puede ir vacía).
+*/
+bool exportarTexto(const string& ruta, const vector<InstanciaPuzzle>& instancias) {
+    ofstream out(ruta);
+    if (!out) return false;
+    for (auto& ins : instancias)
+        out << ins.semilla << ';' << boardToKey(ins.tablero) << ';' << ins.movimientos << '\n';
+    return (bool)out;
+}
+
+/*
+  Importación de texto: acepta líneas "semilla;tablero;movimientos" o solo "tablero"
+  (como las que imprime la GUI). Las líneas vacías se ignoran.
+*/
+vector<InstanciaPuzzle> importarTexto(const string& ruta) {
+    vector<InstanciaPuzzle> res;
+    ifstream in(ruta);
+    string linea;
+    while (getline(in, linea)) {
+        if (!linea.empty() && linea.back() == '\r') linea.pop_back();
+        if (linea.empty()) continue;
+        InstanciaPuzzle ins;
+        size_t p1 = linea.find(';');
+        if (p1 == string::npos) {
+            ins.tablero = keyToBoard(linea);
+        }
+        else {
+            size_t p2 = linea.find(';', p1 + 1);
+            ins.semilla = stoull(linea.substr(0, p1));
+            ins.tablero = keyToBoard(linea.substr(p1 + 1, p2 == string::npos ? string::npos : p2 - p1 - 1));
+            if (p2 != string::npos) ins.movimientos = linea.substr(p2 + 1);
         }
-        cout << "\n\n";
+        res.push_back(ins);
     }
-    cout << flush;
+    return res;
 }
 
-/* ---------------------- Utilidades de estado y solubilidad ---------------------- */
+/* ---------------------- Caché de soluciones con simetría ---------------------- */
 
 /*
-  Convierte el tablero (vector<int>) a string (clave) para usar en visited/parent.
-  Formato: números separados por comas, ej: "1,2,3,0,4"
+  Clave compacta: un byte con n y luego un byte por ficha (dos si N > 256).
+  Mucho más chica y rápida de comparar que boardToKey.
 */
-string boardToKey(const vector<int>& b) {
-    ostringstream oss;
-    for (size_t i = 0; i < b.size(); ++i) {
-        if (i) oss << ',';
-        oss << b[i];
+string claveCompacta(const vector<int>& b, int n) {
+    bool dosBytes = b.size() > 256;
+    string k;
+    k.reserve(1 + b.size() * (dosBytes ? 2 : 1));
+    k.push_back((char)n);
+    for (int v : b) {
+        k.push_back((char)(v & 0xFF));
+        if (dosBytes) k.push_back((char)(v >> 8));
     }
-    return oss.str();
+    return k;
 }
 
 /*
-  Convierte clave a tablero (vector<int>).
+  CacheSoluciones: caché LRU de soluciones óptimas.
+   - La clave es la forma canónica del tablero: la menor clave compacta entre el
+     tablero y su transpuesto, así un tablero y su espejo comparten la entrada.
+   - Al guardar una solución también se registran todos los estados intermedios:
+     el resto del camino desde cada uno es una solución óptima para ese estado.
+     Las entradas comparten el mismo camino (shared_ptr) y solo guardan desde dónde empieza.
+   - persistir/cargar usan el formato de texto de exportarTexto (semilla;tablero;movimientos).
 */
-vector<int> keyToBoard(const string& key) {
-    vector<int> b;
-    stringstream ss(key);
-    string token;
-    while (getline(ss, token, ',')) {
-        b.push_back(stoi(token));
+class CacheSoluciones {
+public:
+    explicit CacheSoluciones(size_t capacidadEntradas = (size_t)1 << 20) : capacidad(capacidadEntradas) {}
+
+    // Devuelve true y los movimientos si el tablero (o su espejo) ya está en la caché.
+    bool buscar(const vector<int>& tablero, int n, string& movs) {
+        bool consultaTranspuesta;
+        string clave = claveCanonica(tablero, n, consultaTranspuesta);
+        auto it = tabla.find(clave);
+        if (it == tabla.end()) return false;
+
+        orden.splice(orden.begin(), orden, it->second.posLRU); // más reciente
+        const Entrada& e = it->second;
+        movs = e.camino->movimientos.substr(e.desde);
+        if (e.transpuesto != consultaTranspuesta) movs = transponerMovimientos(movs);
+        return true;
     }
-    return b;
-}
 
-/*
-  Cuenta inversions para determinar solvabilidad.
-  Regla:
-   - Si n es impar: solvable si inversions es par.
-   - Si n es par: solvable si (inversions + fila_del_hueco_desde_abajo) % 2 == 1
-     (fila desde abajo: 1 = última fila, 2 = penúltima, ...).
-*/
-bool isSolvable(const vector<int>& board, int n) {
-    int N = n * n;
-    int inv = 0;
-    for (int i = 0; i < N; ++i) {
-        if (board[i] == 0) continue;
-        for (int j = i + 1; j < N; ++j) {
-            if (board[j] != 0 && board[j] < board[i]) ++inv;
+    // Registra una solución óptima para "tablero" y para cada estado intermedio.
+    void guardar(const vector<int>& tablero, int n, const string& movs) {
+        auto camino = make_shared<CaminoCache>();
+        camino->inicio = tablero;
+        camino->n = n;
+        camino->movimientos = movs;
+
+        EstadoTablero e(tablero, n);
+        for (size_t i = 0; i <= movs.size(); ++i) {
+            bool t;
+            string clave = claveCanonica(e.tablero(), n, t);
+            auto it = tabla.find(clave);
+            if (it != tabla.end()) {
+                orden.splice(orden.begin(), orden, it->second.posLRU);
+            }
+            else {
+                orden.push_front(clave);
+                tabla.emplace(clave, Entrada{ camino, (uint32_t)i, t, orden.begin() });
+                if (tabla.size() > capacidad) { // expulsar el menos usado
+                    tabla.erase(orden.back());
+                    orden.pop_back();
+                }
+            }
+            if (i < movs.size()) e.applyMove(movs[i]);
         }
     }
-    if (n % 2 == 1) {
-        return (inv % 2 == 0);
-    }
-    else {
-        int zeroIndex = -1;
-        for (int i = 0; i < N; ++i) if (board[i] == 0) { zeroIndex = i; break; }
-        int rowFromTop = zeroIndex / n;         // 0-based
-        int rowFromBottom = n - rowFromTop;     // 1-based
-        // condición conocida para tablero de anchura par
-        return ((inv + rowFromBottom) % 2 == 1);
+
+    size_t size() const { return tabla.size(); }
+
+    bool persistir(const string& ruta) const {
+        // un renglón por camino distinto todavía referenciado
+        unordered_set<const CaminoCache*> escritos;
+        vector<InstanciaPuzzle> filas;
+        for (auto& kv : tabla) {
+            const CaminoCache* c = kv.second.camino.get();
+            if (!escritos.insert(c).second) continue;
+            InstanciaPuzzle ins;
+            ins.semilla = (uint64_t)c->n;
+            ins.tablero = c->inicio;
+            ins.movimientos = c->movimientos;
+            filas.push_back(ins);
+        }
+        return exportarTexto(ruta, filas);
     }
-}
 
-/*
-  Genera un tablero aleatorio pero **solvable** (y distinto del objetivo).
-  - construye 0..N-1, lo baraja hasta que isSolvable sea true y no sea el objetivo.
-*/
-vector<int> generateSolvableBoard(int n) {
-    int N = n * n;
-    vector<int> board(N);
-    for (int i = 0; i < N; ++i) board[i] = i;
+    // Vuelve a registrar los caminos guardados (la "semilla" de cada renglón es n).
+    void cargar(const string& ruta) {
+        for (auto& ins : importarTexto(ruta))
+            if (ins.semilla >= 2 && ins.tablero.size() == ins.semilla * ins.semilla)
+                guardar(ins.tablero, (int)ins.semilla, ins.movimientos);
+    }
 
-    // objetivo para comparar: 1,2,3,...,N-1,0
-    vector<int> goal(N);
-    for (int i = 0; i < N - 1; ++i) goal[i] = i + 1;
-    goal[N - 1] = 0;
+private:
+    struct CaminoCache {
+        vector<int> inicio;
+        int n = 0;
+        string movimientos;
+    };
 
-    // generador aleatorio
-    std::mt19937 rng((unsigned)chrono::high_resolution_clock::now().time_since_epoch().count());
+    struct Entrada {
+        shared_ptr<const CaminoCache> camino;
+        uint32_t desde;          // movimientos ya hechos desde camino->inicio
+        bool transpuesto;        // la clave canónica corresponde al estado transpuesto
+        list<string>::iterator posLRU;
+    };
 
-    do {
-        shuffle(board.begin(), board.end(), rng);
-    } while (!isSolvable(board, n) || board == goal); // evitar estado resuelto inicial
+    size_t capacidad;
+    list<string> orden;          // frente = usado más recientemente
+    unordered_map<string, Entrada> tabla;
 
-    return board;
-}
+    static string claveCanonica(const vector<int>& b, int n, bool& transpuesto) {
+        string k = claveCompacta(b, n);
+        string kt = claveCompacta(transponerTablero(b, n), n);
+        transpuesto = kt < k;
+        return transpuesto ? kt : k;
+    }
+};
 
-/* ---------------------- Aplicación de movimientos ---------------------- */
+/* ---------------------- Modo servicio (motor caliente por stdin/stdout) ---------------------- */
 
 /*
-  Aplica un movimiento al estado:
-   'U' = mover hueco hacia arriba (intercambia con la casilla de arriba)
-   'D' = hacia abajo
-   'L' = izquierda
-   'R' = derecha
-  Devuelve true si el movimiento fue válido y aplicado.
+  Modo servicio: el programa queda corriendo y resuelve peticiones que llegan por stdin,
+  una por línea, respondiendo por stdout. Así las interfaces y las pruebas de carga
+  comparten un mismo motor ya inicializado en vez de arrancar en frío en cada solve.
+
+  Protocolo (texto, una línea por mensaje):
+    petición:   <id> <n> <tablero> [objetivo]   ej: 7 3 1,2,3,4,5,6,0,7,8
+                (sin objetivo = 1..N-1,0; con objetivo se normaliza con NormalizacionObjetivo)
+    respuesta:  <id> OK <movimientos>           ej: 7 OK RR   (vacío si ya estaba resuelto)
+                <id> APROX <movimientos>        solución válida pero quizás no óptima
+                <id> FALLO <motivo>
+  OK siempre es una solución óptima. Si el hueco del objetivo no está en una esquina la
+  normalización no es exacta (NormalizacionObjetivo::exacta): para n <= 3 se hace un BFS de
+  frontera directo hacia ese objetivo (óptimo, sin caché); para n mayores se resuelve el
+  tablero normalizado y la respuesta sale como APROX (hasta 2(n-1) movimientos de más).
+    SALIR       termina el servicio después de responder lo pendiente.
+
+  Las respuestas pueden salir en otro orden que las peticiones (por eso llevan id).
+  Cada hilo toma una petición a la vez, así varios tableros se resuelven en paralelo. Un
+  tablero que ya se está resolviendo en otro hilo no se vuelve a resolver: la petición
+  queda esperando en enCurso y recibe la misma respuesta. Las soluciones quedan en una CacheSoluciones compartida
+  (opcionalmente persistida en archivoCache al terminar). La tabla exacta 3x3 y la
+  base de patrones 4x4 se construyen al arrancar y se reutilizan en cada petición.
 */
-bool applyMove(vector<int>& state, int n, char move) {
-    int N = n * n;
-    int zero = -1;
-    for (int i = 0; i < N; ++i) if (state[i] == 0) { zero = i; break; }
-    int zr = zero / n, zc = zero % n;
-    int nr = zr, nc = zc;
-    if (move == 'U') nr = zr - 1;
-    else if (move == 'D') nr = zr + 1;
-    else if (move == 'L') nc = zc - 1;
-    else if (move == 'R') nc = zc + 1;
-    else return false;
-
-    if (nr < 0 || nr >= n || nc < 0 || nc >= n) return false;
-    swap(state[zero], state[nr * n + nc]);
+// true si b tiene n*n casillas con los valores 0..n*n-1 una vez cada uno
+bool esPermutacion(const vector<int>& b, int n) {
+    if (n < 1 || n > 46340) return false; // n*n tiene que caber en un int
+    if ((int)b.size() != n * n) return false;
+    vector<char> visto(b.size(), 0);
+    for (int v : b) {
+        if (v < 0 || v >= n * n || visto[v]) return false;
+        visto[v] = 1;
+    }
     return true;
 }
 
-/* ---------------------- BFS (cola FIFO) que devuelve la secuencia de estados ---------------------- */
+struct PeticionServicio {
+    string id;
+    int n = 0;
+    vector<int> tablero;                                // ya normalizado si vino un objetivo
+    shared_ptr<NormalizacionObjetivo> normalizacion;    // nullptr = objetivo de siempre
+    vector<int> objetivo;                               // no vacío = BFS directo a este objetivo
+};
+
+class MotorServicio {
+public:
+    MotorServicio(int hilos, size_t presupuestoPorSolve, int timeLimitSeconds, const string& archivoCache = "")
+        : presupuesto(presupuestoPorSolve), timeout(timeLimitSeconds), rutaCache(archivoCache), pdb4(4), wd4(4),
+          perimetro4(perimetroPara(4)) {
+        if (!rutaCache.empty()) cache.cargar(rutaCache);
+        if (hilos < 1) hilos = 1;
+        for (int i = 0; i < hilos; ++i) trabajadores.emplace_back([this] { trabajar(); });
+    }
+
+    ~MotorServicio() { detener(); }
+
+    // Lee peticiones de "in" hasta EOF o SALIR y escribe las respuestas en "out".
+    void ejecutar(istream& in, ostream& out) {
+        salida = &out;
+        string linea;
+        while (getline(in, linea)) {
+            if (!linea.empty() && linea.back() == '\r') linea.pop_back();
+            if (linea.empty()) continue;
+            if (linea == "SALIR") break;
+
+            istringstream ss(linea);
+            PeticionServicio pet;
+            string tablero, objetivo;
+            if (!(ss >> pet.id >> pet.n >> tablero) || pet.n < 2) {
+                responder(pet.id.empty() ? "?" : pet.id, "FALLO peticion_invalida");
+                continue;
+            }
+            ss >> objetivo; // opcional
+            vector<int> tableroObjetivo;
+            try {
+                pet.tablero = keyToBoard(tablero);
+                if (!objetivo.empty()) tableroObjetivo = keyToBoard(objetivo);
+            }
+            catch (...) {
+                pet.tablero.clear();
+            }
+            if (!esPermutacion(pet.tablero, pet.n) || (!objetivo.empty() && !esPermutacion(tableroObjetivo, pet.n))) {
+                responder(pet.id, "FALLO tablero_invalido");
+                continue;
+            }
+            if (!objetivo.empty() && pet.tablero == tableroObjetivo) {
+                responder(pet.id, "OK ");
+                continue;
+            }
+            if (!objetivo.empty()) {
+                // resolver el tablero equivalente hacia 1..N-1,0 (tablas y caché de siempre)
+                auto norm = make_shared<NormalizacionObjetivo>(tableroObjetivo, pet.n);
+                if (norm->exacta() || pet.n > 3) {
+                    pet.normalizacion = norm;
+                    pet.tablero = norm->normalizar(pet.tablero);
+                }
+                else {
+                    pet.objetivo = move(tableroObjetivo); // chico: BFS óptimo hacia el objetivo real
+                }
+            }
+            {
+                lock_guard<mutex> lk(mtx);
+                pendientes.push_back(move(pet));
+            }
+            hayTrabajo.notify_one();
+        }
+        detener();
+    }
+
+private:
+    size_t presupuesto;
+    int timeout;
+    ostream* salida = nullptr;
+
+    string rutaCache;             // vacío = caché solo en memoria
+    mutex mtxCache;
+    CacheSoluciones cache;
+
+    // tablas que se construyen una vez al arrancar y quedan calientes (solo lectura)
+    TablaExacta3x3 tabla3;
+    BasePatrones pdb4;
+    DistanciaCaminata wd4;        // walking distance para 4x4 (menos de 1 MB)
+    const TablaPerimetro* perimetro4; // se arma al iniciar, como las otras tablas
+
+    mutex mtx;                    // protege pendientes, enCurso y fin
+    mutex mtxSalida;              // una respuesta a la vez en stdout
+    condition_variable hayTrabajo;
+    deque<PeticionServicio> pendientes;
+    // tableros que algún hilo está resolviendo -> peticiones repetidas que esperan su respuesta
+    unordered_map<string, vector<PeticionServicio>> enCurso;
+    bool fin = false;
+    vector<thread> trabajadores;
+
+    void detener() {
+        {
+            lock_guard<mutex> lk(mtx);
+            fin = true;
+        }
+        hayTrabajo.notify_all();
+        for (auto& t : trabajadores) if (t.joinable()) t.join();
+        if (!trabajadores.empty() && !rutaCache.empty()) cache.persistir(rutaCache);
+        trabajadores.clear();
+    }
+
+    void responder(const string& id, const string& texto) {
+        lock_guard<mutex> lk(mtxSalida);
+        (*salida) << id << ' ' << texto << '\n' << flush;
+    }
+
+    // responde una petición con la respuesta de su tablero normalizado
+    // (APROX si la normalización no era exacta: la solución puede no ser óptima)
+    void responderCon(const PeticionServicio& pet, const string& texto) {
+        if (pet.normalizacion && texto.compare(0, 3, "OK ") == 0)
+            responder(pet.id, (pet.normalizacion->exacta() ? "OK " : "APROX ")
+                              + pet.normalizacion->movimientosOriginales(texto.substr(3)));
+        else
+            responder(pet.id, texto);
+    }
+
+    // "OK <movimientos>" o "FALLO <motivo>" para el tablero (ya normalizado) de pet
+    string resolver(const PeticionServicio& pet) {
+        if (!pet.objetivo.empty()) {
+            if (isSolvable(pet.tablero, pet.n) != isSolvable(pet.objetivo, pet.n)) return "FALLO no_solvable";
+            auto r = bfsFronteraSolve(pet.tablero, pet.n, presupuesto, timeout, pet.objetivo);
+            return r.first ? "OK " + movimientosDesdeClaves(r.second, pet.n) : "FALLO limite";
+        }
+
+        string movs;
+        bool enCache;
+        {
+            lock_guard<mutex> lk(mtxCache);
+            enCache = cache.buscar(pet.tablero, pet.n, movs);
+        }
+        if (enCache) return "OK " + movs;
+        if (!isSolvable(pet.tablero, pet.n)) return "FALLO no_solvable";
+
+        bool ok = true;
+        if (pet.n == 3) {
+            movs = tabla3.solucion(pet.tablero);
+        }
+        else {
+            auto r = (pet.n == 4)
+                ? idaSolve(pet.tablero, 4, chrono::steady_clock::now() + chrono::seconds(timeout), &pdb4, &wd4,
+                          perimetro4)
+                : bfsSolve(pet.tablero, pet.n, presupuesto, timeout);
+            ok = r.first;
+            if (ok) movs = movimientosDesdeClaves(r.second, pet.n);
+        }
+        if (!ok) return "FALLO limite";
+        lock_guard<mutex> lk(mtxCache);
+        cache.guardar(pet.tablero, pet.n, movs);
+        return "OK " + movs;
+    }
+
+    void trabajar() {
+        while (true) {
+            PeticionServicio pet;
+            string clave;
+            {
+                unique_lock<mutex> lk(mtx);
+                hayTrabajo.wait(lk, [this] { return fin || !pendientes.empty(); });
+                if (pendientes.empty()) return; // fin y nada pendiente
+                pet = move(pendientes.front());
+                pendientes.pop_front();
+
+                // el mismo tablero ya se está resolviendo: esperar esa respuesta
+                clave = to_string(pet.n) + ':' + boardToKey(pet.tablero);
+                if (!pet.objetivo.empty()) clave += '>' + boardToKey(pet.objetivo);
+                auto it = enCurso.find(clave);
+                if (it != enCurso.end()) {
+                    it->second.push_back(move(pet));
+                    continue;
+                }
+                enCurso.emplace(clave, vector<PeticionServicio>());
+            }
+
+            string texto = resolver(pet);
+
+            vector<PeticionServicio> esperando;
+            {
+                lock_guard<mutex> lk(mtx);
+                auto it = enCurso.find(clave);
+                esperando = move(it->second);
+                enCurso.erase(it);
+            }
+            responderCon(pet, texto);
+            for (const auto& otra : esperando) responderCon(otra, texto);
+        }
+    }
+};
+
+/* ---------------------- Banco de pruebas (--bench) con contadores de hardware ---------------------- */
 
 /*
-  bfsSolve:
-    - start: estado inicial (vector<int> tamaño n*n)
-    - n: dimensión
-    - maxNodes: límite de nodos explorados (seguridad)
-    - timeLimitSeconds: límite de tiempo en segundos (seguridad)
-  Devuelve: pair<bool, vector<string>>
-    - first = true si se encontró solución
-    - second = secuencia de claves (keys) desde inicio hasta objetivo (incluyendo ambos)
+  ContadoresHardware: ciclos, instrucciones, fallos de LLC, fallos de predicción de saltos y
+  fallos de dTLB de este hilo, leídos con perf_event_open (solo Linux). Cada contador se abre
+  por separado: si el kernel o la máquina no permiten alguno (perf_event_paranoid, máquina
+  virtual sin PMU, otro sistema operativo) ese queda en -1 y el resto se mide igual.
+  Si el kernel tuvo que turnar los contadores, el valor se escala por tiempo habilitado/corriendo.
 */
+class ContadoresHardware {
+public:
+    enum { CICLOS, INSTRUCCIONES, FALLOS_LLC, FALLOS_SALTO, FALLOS_DTLB, CANTIDAD };
 
+    static const char* nombre(int i) {
+        static const char* nombres[CANTIDAD] = { "ciclos", "instrucciones", "fallos LLC", "fallos salto", "fallos dTLB" };
+        return nombres[i];
+    }
 
-// ❤️ ❤️ ❤️ APLICAMOS BFS CON COLA 
+    ContadoresHardware() {
+        fds.fill(-1);
+        valores.fill(-1);
+#ifdef __linux__
+        const uint64_t LECTURA_FALLO = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const uint32_t tipos[CANTIDAD] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                           PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+        const uint64_t configs[CANTIDAD] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                             PERF_COUNT_HW_CACHE_LL | LECTURA_FALLO, PERF_COUNT_HW_BRANCH_MISSES,
+                                             PERF_COUNT_HW_CACHE_DTLB | LECTURA_FALLO };
+        for (int i = 0; i < CANTIDAD; ++i) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = tipos[i];
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1; // solo el código del solve (y funciona con perf_event_paranoid = 2)
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0); // este hilo, cualquier CPU
+            if (fds[i] < 0 && i == FALLOS_LLC) { // sin el evento de caché LL: el genérico (casi siempre LLC)
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            }
+            if (fds[i] < 0 && motivo.empty()) motivo = strerror(errno);
+        }
+#else
+        motivo = "perf_event_open solo existe en Linux";
+#endif
+    }
+
+    ContadoresHardware(const ContadoresHardware&) = delete;
+    ContadoresHardware& operator=(const ContadoresHardware&) = delete;
+
+    ~ContadoresHardware() {
+#ifdef __linux__
+        for (int fd : fds) if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool disponible(int i) const { return fds[i] >= 0; }
+    const string& motivoFalla() const { return motivo; } // por qué no se abrió el primero que faltó
+
+    void iniciar() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void detener() {
+#ifdef __linux__
+        for (int i = 0; i < CANTIDAD; ++i) {
+            if (fds[i] < 0) continue;
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t lectura[3]; // valor, tiempo habilitado, tiempo corriendo
+            if (read(fds[i], lectura, sizeof(lectura)) != (ssize_t)sizeof(lectura) || lectura[2] == 0) {
+                valores[i] = -1;
+                continue;
+            }
+            valores[i] = (long long)((double)lectura[0] * lectura[1] / lectura[2]);
+        }
+#endif
+    }
+
+    long long valor(int i) const { return valores[i]; } // -1 = no disponible
+
+private:
+    array<int, CANTIDAD> fds;
+    array<long long, CANTIDAD> valores;
+    string motivo;
+};
 
 /*
-  bfsSolve:
-    - start: tablero inicial (vector<int> de tamaño n*n)
-    - n: dimensión del puzzle
-    - maxNodes: límite de nodos explorados (seguridad)
-    - timeLimitSeconds: límite de tiempo en segundos (seguridad)
-  Devuelve: pair<bool, vector<string>>
-    - first = true si se encontró solución
-    - second = vector de strings con la secuencia de tableros desde inicio hasta objetivo
+  Banco de pruebas: "programa --bench [n] [cantidad] [semilla] [segundos] [distancia]".
+  Resuelve los mismos tableros (GeneradorTableros con la semilla dada: aleatorios para n <= 3,
+  caminatas de 40 movimientos para n mayores; con distancia > 0, conDistancia(n, distancia)
+  para fijar la dificultad) con cada solver y muestra por solver el total de
+  tiempo, nodos expandidos, nodos/s y los contadores de hardware con IPC y fallos por nodo.
+  Antes de medir cada solver se resuelve una vez el primer tablero sin contarlo.
 */
+// tableros de prueba reproducibles: los de siempre con distancia 0, o de esa dificultad
+vector<vector<int>> tablerosDePrueba(int n, int cantidad, uint64_t semilla, int distancia, int* distanciaObtenida = nullptr) {
+    GeneradorTableros gen(semilla);
+    vector<vector<int>> tableros;
+    for (int i = 0; i < cantidad; ++i) {
+        if (distancia > 0) tableros.push_back(gen.conDistancia(n, distancia, distanciaObtenida));
+        else tableros.push_back(n <= 3 ? gen.aleatorio(n) : gen.caminata(n, 40));
+    }
+    return tableros;
+}
 
-// nuestra funcion bfsSolve devuelve 2 cosas
-// un bool para si encontro o no la solucion
-// un vector lista de strings que representa la secuencia de tableros desde el estado inicial hasta el objetivo.
-// Cada string se obtiene con la función boardToKey, que convierte un tablero en un string del tipo "1,2,3,0,4".
-// Así podemos reconstruir todos los pasos que BFS encontró para llegar a la solución.
-pair<bool, vector<string>> bfsSolve(const vector<int>& start, int n, size_t maxNodes = 600000, int timeLimitSeconds = 30) 
-{
-    vector<string> emptyRes; // resultado vacío para devolver si no hay solución
+int ejecutarBanco(int n, int cantidad, uint64_t semilla, int segundos, int distancia) {
+    int obtenida = 0;
+    vector<vector<int>> tableros = tablerosDePrueba(n, cantidad, semilla, distancia, &obtenida);
 
-    // limitar BFS a n <= 3 por practicidad (2x2 y 3x3)
-    if (n > 3) return { false, emptyRes };
+    const size_t presupuesto = (size_t)256 << 20;
+    struct Solver { string nombre; function<bool(const vector<int>&)> resolver; };
+    vector<Solver> solvers = {
+        { "bfsSolve", [&](const vector<int>& b) { return bfsSolve(b, n, presupuesto, segundos).first; } },
+        { "bfsOrdenadoSolve", [&](const vector<int>& b) {
+            bool agotado;
+            return bfsOrdenadoSolve(b, n, presupuesto, chrono::steady_clock::now() + chrono::seconds(segundos), agotado).first;
+        } },
+        { "bfsFronteraSolve", [&](const vector<int>& b) { return bfsFronteraSolve(b, n, presupuesto, segundos).first; } },
+        { "idaSolve", [&](const vector<int>& b) {
+            return idaSolve(b, n, chrono::steady_clock::now() + chrono::seconds(segundos), nullptr, nullptr,
+                            perimetroPara(n)).first;
+        } },
+    };
 
-    int N = n * n;
+    ContadoresHardware contadores;
+    if (!contadores.motivoFalla().empty())
+        cout << "Aviso: no se pudieron abrir todos los contadores de hardware (" << contadores.motivoFalla() << ")\n";
+    cout << tableros.size() << " tableros de " << n << "x" << n << ", semilla " << semilla;
+    if (distancia > 0) cout << ", distancia " << obtenida << (n <= 3 ? " (exacta)" : " (manhattan de la caminata)");
+    cout << "\n\n";
 
-    // ---------------- Construir tablero objetivo ----------------
-    vector<int> goalVec(N);
-    for (int i = 0; i < N - 1; ++i) goalVec[i] = i + 1; // números 1..N-1
-    goalVec[N - 1] = 0; // hueco al final
-    string goalKey = boardToKey(goalVec); // clave string del objetivo
-    string startKey = boardToKey(start);  // clave string del tablero inicial
+    for (auto& solver : solvers) {
+        array<long long, ContadoresHardware::CANTIDAD> total;
+        total.fill(0);
+        size_t nodos = 0, resueltos = 0;
+        double tiempo = 0;
+        solver.resolver(tableros[0]); // calentamiento: tablas estáticas (autómata, etc.) y cachés
+        for (auto& b : tableros) {
+            nodosExpandidos = 0;
+            auto t0 = chrono::steady_clock::now();
+            contadores.iniciar();
+            bool ok = solver.resolver(b);
+            contadores.detener();
+            tiempo += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+            nodos += nodosExpandidos;
+            resueltos += ok;
+            for (int i = 0; i < ContadoresHardware::CANTIDAD; ++i)
+                if (total[i] >= 0) total[i] = contadores.valor(i) < 0 ? -1 : total[i] + contadores.valor(i);
+        }
 
-    if (startKey == goalKey) { // si ya está resuelto
-        return { true, vector<string>{startKey} };
+        cout << solver.nombre << ": " << resueltos << "/" << tableros.size() << " resueltos, "
+             << fixed << setprecision(3) << tiempo << " s, " << nodos << " nodos, "
+             << setprecision(0) << (tiempo > 0 ? nodos / tiempo : 0.0) << " nodos/s\n";
+        for (int i = 0; i < ContadoresHardware::CANTIDAD; ++i) {
+            cout << "    " << left << setw(14) << ContadoresHardware::nombre(i) << right;
+            if (total[i] < 0) { cout << setw(16) << "n/d" << "\n"; continue; }
+            cout << setw(16) << total[i];
+            if (nodos > 0) cout << "   " << setprecision(2) << (double)total[i] / nodos << " por nodo";
+            cout << "\n";
+        }
+        if (total[ContadoresHardware::CICLOS] > 0 && total[ContadoresHardware::INSTRUCCIONES] >= 0)
+            cout << "    IPC           " << setw(16) << setprecision(2)
+                 << (double)total[ContadoresHardware::INSTRUCCIONES] / total[ContadoresHardware::CICLOS] << "\n";
+        cout << defaultfloat << "\n";
     }
+    return 0;
+}
 
-    // ---------------- Inicializar estructuras BFS ----------------
-    queue<vector<int>> q;            // CREACION de cola FIFO de tableros por explorar
-    unordered_set<string> visited;   // conjunto de tableros ya visitados
-    unordered_map<string, string> parent;   // mapa de padres para reconstruir camino
-    unordered_map<string, char> moveTaken; // movimiento que generó cada tablero
+/* ---------------------- Microbenchmarks de las primitivas (--micro) ---------------------- */
 
-    q.push(start);         // agregar tablero inicial a la cola
-    visited.insert(startKey); // marcar como visitado
-    parent[startKey] = "";    // raíz no tiene padre
+/*
+  Tiempos finos de las funciones que están en el camino caliente de las búsquedas, para
+  decidir con números si un reemplazo conviene:
+   - entrada realista: tableros de caminatas al azar desde el objetivo con largo uniforme en
+     0..80 (los que aparecen en una búsqueda real), más las claves y estados derivados de ellos;
+   - cada medición recorre toda la entrada tantas vueltas como hagan falta para pasar de
+     MS_POR_REPETICION (el reloj no influye) y da ns por operación;
+   - REPETICIONES_CALENTAMIENTO vueltas sin contar y REPETICIONES_MICRO contadas, de las que
+     se informa media, intervalo de confianza del 95% (t de Student), mediana y mínimo.
+  Los resultados de cada operación se suman en sumideroMicro para que el compilador no
+  borre el trabajo.
+*/
+const int REPETICIONES_MICRO = 20;
+const int REPETICIONES_CALENTAMIENTO = 3;
+const double MS_POR_REPETICION = 2.0;
+const double T_STUDENT_95 = 2.093; // t(0.975) con REPETICIONES_MICRO - 1 = 19 grados de libertad
 
-    // ---------------- Definir movimientos posibles ----------------
-    int dr[4] = { -1, 1, 0, 0 }; // cambio de fila para U,D,L,R
-    int dc[4] = { 0, 0, -1, 1 }; // cambio de columna para U,D,L,R
-    char mc[4] = { 'U','D','L','R' }; // representación del movimiento
+volatile uint64_t sumideroMicro = 0;
 
-    size_t nodes = 0;  // contador de nodos explorados
-    auto t0 = chrono::steady_clock::now(); // tiempo inicial
+struct ResultadoMicro {
+    double media = 0, ic95 = 0, mediana = 0, minimo = 0; // ns por operación
+};
 
-    // ---------------- Bucle principal BFS ----------------
-    while (!q.empty()) {
-        // ---------- Límites de seguridad ----------
-        auto now = chrono::steady_clock::now();
-        auto elapsed = chrono::duration_cast<chrono::seconds>(now - t0).count();
-        if (elapsed > timeLimitSeconds) return { false, emptyRes }; // timeout
-        if (nodes > maxNodes) return { false, emptyRes };           // límite de nodos
+// cuerpo() hace "operaciones" operaciones y devuelve algo que dependa de todas
+ResultadoMicro medirMicro(size_t operaciones, const function<uint64_t()>& cuerpo) {
+    // calibrar: cuántas vueltas del cuerpo por repetición
+    auto t0 = chrono::steady_clock::now();
+    sumideroMicro = sumideroMicro + cuerpo();
+    double msVuelta = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    size_t vueltas = max<size_t>(1, (size_t)ceil(MS_POR_REPETICION / max(msVuelta, 1e-6)));
 
-        // ---------- Tomar tablero actual ----------
-        vector<int> cur = q.front(); q.pop(); // sacar de la cola
-        ++nodes;                               // contar nodo explorado
-        string curKey = boardToKey(cur);       // clave string
+    vector<double> muestras;
+    for (int r = 0; r < REPETICIONES_CALENTAMIENTO + REPETICIONES_MICRO; ++r) {
+        uint64_t acumulado = 0;
+        auto inicio = chrono::steady_clock::now();
+        for (size_t v = 0; v < vueltas; ++v) acumulado += cuerpo();
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - inicio).count();
+        sumideroMicro = sumideroMicro + acumulado;
+        if (r >= REPETICIONES_CALENTAMIENTO) muestras.push_back(ns / (double)(vueltas * operaciones));
+    }
 
-        // ---------- Ubicar el hueco ----------
-        int zero = -1;
-        for (int i = 0; i < N; ++i) if (cur[i] == 0) { zero = i; break; }
-        int zr = zero / n;  // fila del hueco
-        int zc = zero % n;  // columna del hueco
+    ResultadoMicro res;
+    for (double m : muestras) res.media += m;
+    res.media /= muestras.size();
+    double varianza = 0;
+    for (double m : muestras) varianza += (m - res.media) * (m - res.media);
+    varianza /= (muestras.size() - 1);
+    res.ic95 = T_STUDENT_95 * sqrt(varianza / muestras.size());
+    sort(muestras.begin(), muestras.end());
+    res.mediana = (muestras[muestras.size() / 2] + muestras[(muestras.size() - 1) / 2]) / 2;
+    res.minimo = muestras.front();
+    return res;
+}
 
-        // ---------- Generar tableros hijos ----------
-        for (int k = 0; k < 4; ++k) {
-            int nr = zr + dr[k];  // nueva fila tras movimiento
-            int nc = zc + dc[k];  // nueva columna tras movimiento
-            if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue; // fuera del tablero
+int ejecutarMicro(int n, uint64_t semilla) {
+    const size_t CANTIDAD = 4096; // tableros de entrada (caben en la caché L2)
+    int N = n * n;
+    GeneradorTableros gen(semilla);
+    mt19937_64 rng(semilla);
+    vector<vector<int>> tableros;
+    for (size_t i = 0; i < CANTIDAD; ++i) tableros.push_back(gen.caminata(n, (int)(rng() % 81)));
 
-            vector<int> nxt = cur;
-            swap(nxt[zero], nxt[nr * n + nc]); // mover hueco
-            string nxtKey = boardToKey(nxt); // clave del tablero hijo
+    vector<string> claves;
+    for (auto& b : tableros) claves.push_back(boardToKey(b));
+    // para las búsquedas que fallan: caminatas más largas (81..160), casi todas fuera de "tableros"
+    vector<vector<int>> otrosTableros;
+    for (size_t i = 0; i < CANTIDAD; ++i) otrosTableros.push_back(gen.caminata(n, 81 + (int)(rng() % 80)));
+    vector<string> clavesAusentes;
+    for (auto& b : otrosTableros) clavesAusentes.push_back(boardToKey(b));
+    unordered_set<string> conjuntoLleno(claves.begin(), claves.end());
+    vector<EstadoTablero> estados;
+    for (auto& b : tableros) estados.emplace_back(b, n);
+    vector<int> primerMovimiento; // un movimiento válido por tablero
+    for (auto& b : tableros) {
+        int z = int(find(b.begin(), b.end(), 0) - b.begin());
+        primerMovimiento.push_back(z >= n ? 0 : 1); // U si no está en la fila de arriba, si no D
+    }
 
-            // ---------- Revisar si ya fue visitado ----------
-            if (visited.find(nxtKey) != visited.end()) continue; // ya visto
-            visited.insert(nxtKey);      // marcar visitado
-            parent[nxtKey] = curKey;     // guardar padre
-            moveTaken[nxtKey] = mc[k];   // guardar movimiento
+    // camino de claves para la reconstrucción: una solución real de 3x3 (o un paseo largo)
+    vector<string> camino;
+    {
+        vector<int> b = gen.caminata(n, 30);
+        auto res = (n <= 3) ? bfsSolve(b, n) : pair<bool, vector<string>>{ false, {} };
+        if (res.first) camino = res.second;
+        else {
+            EstadoTablero e(b, n);
+            camino.push_back(boardToKey(b));
+            for (int p = 0; p < 30; ++p) {
+                int z = e.hueco();
+                int k = (z >= n) ? 0 : 1;
+                e.applyMove(k);
+                camino.push_back(boardToKey(e.tablero()));
+            }
+        }
+    }
 
-            // ---------- Comprobar si llegamos al objetivo ----------
-            if (nxtKey == goalKey) {
-                vector<string> path;
-                string curk = nxtKey;
-                while (!curk.empty()) {   // reconstruir camino desde objetivo hasta inicio
-                    path.push_back(curk);
-                    curk = parent[curk];
+    struct Caso { string nombre; size_t operaciones; function<uint64_t()> cuerpo; };
+    vector<Caso> casos = {
+        { "boardToKey", CANTIDAD, [&] {
+            uint64_t x = 0;
+            for (auto& b : tableros) x += boardToKey(b).size();
+            return x;
+        } },
+        { "keyToBoard", CANTIDAD, [&] {
+            uint64_t x = 0;
+            for (auto& k : claves) x += keyToBoard(k)[0];
+            return x;
+        } },
+        { "isSolvable", CANTIDAD, [&] {
+            uint64_t x = 0;
+            for (auto& b : tableros) x += isSolvable(b, n);
+            return x;
+        } },
+        { "applyMove + undoMove", CANTIDAD, [&] {
+            uint64_t x = 0;
+            for (size_t i = 0; i < CANTIDAD; ++i) {
+                estados[i].applyMove(primerMovimiento[i]);
+                x += estados[i].heuristica();
+                estados[i].undoMove(primerMovimiento[i]);
+            }
+            return x;
+        } },
+        { "hijos vector + clave (bfsSolve)", CANTIDAD, [&] {
+            // lo mismo que hace el BFS con cola por cada nodo expandido
+            static const int dr[4] = { -1, 1, 0, 0 };
+            static const int dc[4] = { 0, 0, -1, 1 };
+            uint64_t x = 0;
+            for (auto& cur : tableros) {
+                int zero = int(find(cur.begin(), cur.end(), 0) - cur.begin());
+                for (int k = 0; k < 4; ++k) {
+                    int nr = zero / n + dr[k], nc = zero % n + dc[k];
+                    if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
+                    vector<int> nxt = cur;
+                    swap(nxt[zero], nxt[nr * n + nc]);
+                    x += boardToKey(nxt).size();
                 }
-                reverse(path.begin(), path.end()); // ordenar de inicio a objetivo
-                return { true, path };              // devolver solución
             }
+            return x;
+        } },
+        { "unordered_set<string> insertar", CANTIDAD, [&] {
+            unordered_set<string> visitados;
+            for (auto& k : claves) visitados.insert(k);
+            return (uint64_t)visitados.size();
+        } },
+        { "unordered_set<string> buscar (presente)", CANTIDAD, [&] {
+            uint64_t x = 0;
+            for (auto& k : claves) x += conjuntoLleno.count(k);
+            return x;
+        } },
+        { "unordered_set<string> buscar (ausente)", CANTIDAD, [&] {
+            uint64_t x = 0;
+            for (auto& k : clavesAusentes) x += conjuntoLleno.count(k);
+            return x;
+        } },
+        { "movimientosDesdeClaves (por paso)", camino.size(), [&] {
+            return (uint64_t)movimientosDesdeClaves(camino, n).size();
+        } },
+    };
 
-            // ---------- Agregar tablero hijo a la cola ----------
-            q.push(nxt); // se explorará más adelante
+    // entradas empaquetadas (n <= 4); viven fuera del if porque los casos las capturan
+    vector<uint64_t> empaquetados, empaquetadosAusentes;
+    vector<uint8_t> huecos;
+    TablaVisitados llena;
+    if (n <= 4) {
+        for (auto& b : tableros) {
+            empaquetados.push_back(empaquetarTablero(b));
+            huecos.push_back((uint8_t)(find(b.begin(), b.end(), 0) - b.begin()));
         }
+        for (auto& b : otrosTableros) empaquetadosAusentes.push_back(empaquetarTablero(b));
+        for (uint64_t e : empaquetados) llena.insertar(e);
+
+        casos.push_back({ "empaquetarTablero", CANTIDAD, [&] {
+            uint64_t x = 0;
+            for (auto& b : tableros) x += empaquetarTablero(b);
+            return x;
+        } });
+        casos.push_back({ "desempaquetarTablero", CANTIDAD, [&] {
+            uint64_t x = 0;
+            for (uint64_t e : empaquetados) x += desempaquetarTablero(e, N)[0];
+            return x;
+        } });
+        casos.push_back({ "hijos empaquetados (bfsCapasSolve)", CANTIDAD, [&] {
+            static const int dr[4] = { -1, 1, 0, 0 };
+            static const int dc[4] = { 0, 0, -1, 1 };
+            uint64_t x = 0;
+            for (size_t i = 0; i < CANTIDAD; ++i) {
+                uint64_t s = empaquetados[i];
+                int zero = huecos[i];
+                for (int k = 0; k < 4; ++k) {
+                    int nr = zero / n + dr[k], nc = zero % n + dc[k];
+                    if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
+                    int nz = nr * n + nc;
+                    uint64_t v = (s >> (4 * nz)) & 0xF;
+                    x += (s & ~((uint64_t)0xF << (4 * nz))) | (v << (4 * zero));
+                }
+            }
+            return x;
+        } });
+        casos.push_back({ "TablaVisitados insertar", CANTIDAD, [&] {
+            TablaVisitados t;
+            uint64_t x = 0;
+            for (uint64_t e : empaquetados) x += t.insertar(e);
+            return x;
+        } });
+        casos.push_back({ "TablaVisitados buscar (presente)", CANTIDAD, [&] {
+            uint64_t x = 0;
+            for (uint64_t e : empaquetados) x += llena.contiene(e);
+            return x;
+        } });
+        casos.push_back({ "TablaVisitados buscar (ausente)", CANTIDAD, [&] {
+            uint64_t x = 0;
+            for (uint64_t e : empaquetadosAusentes) x += llena.contiene(e);
+            return x;
+        } });
     }
 
-    // si la cola se vacía y no encontramos solución
-    return { false, emptyRes };
+    cout << "Microbenchmarks " << n << "x" << n << " (semilla " << semilla << ", " << REPETICIONES_MICRO
+         << " repeticiones + " << REPETICIONES_CALENTAMIENTO << " de calentamiento)\n\n";
+    cout << left << setw(42) << "primitiva" << right << setw(12) << "ns/op" << setw(10) << "+-IC95"
+         << setw(12) << "mediana" << setw(12) << "minimo" << "\n";
+    cout << fixed << setprecision(2);
+    for (auto& c : casos) {
+        ResultadoMicro r = medirMicro(c.operaciones, c.cuerpo);
+        cout << left << setw(42) << c.nombre << right << setw(12) << r.media << setw(10) << r.ic95
+             << setw(12) << r.mediana << setw(12) << r.minimo << "\n";
+    }
+    cout << defaultfloat;
+    return 0;
 }
 
-
 /* ---------------------- Interacción: modo jugar (flechas) ---------------------- */
 
 /*
   Modo interactivo:
    - state: tablero inicial (vector<int>).
    - n: dimensión.
-   - Lee flechas con _getch(). Si el usuario pulsa 'S' o 's', sale y retorna al prompt.
+   - Lee flechas con leerTecla(). Si el usuario pulsa 'S' o 's', sale y retorna al prompt.
+   - Cada jugada redibuja la pantalla completa en un solo cuadro.
 */
-void playMode(vector<int> state, int n) {
+void playMode(const vector<int>& state, int n) {
+    EstadoTablero estado(state, n);
     while (true) {
-        printBoard(state, n);
-        cout << "Modo jugar: usa flechas para mover el hueco. Presiona 'S' para salir.\n";
+        escribirTerminal(ANSI_LIMPIAR + dibujarTablero(estado.tablero(), n)
+                         + "Modo jugar: usa flechas para mover el hueco. Presiona 'S' para salir.\n");
 
-        int ch = _getch();
-        if (ch == 224) { // teclas especiales en Windows
-            int ch2 = _getch();
-            if (ch2 == 72) applyMove(state, n, 'U'); // ↑
-            else if (ch2 == 80) applyMove(state, n, 'D'); // ↓
-            else if (ch2 == 75) applyMove(state, n, 'L'); // ←
-            else if (ch2 == 77) applyMove(state, n, 'R'); // →
-        }
+        int ch = leerTecla();
+        if (ch == TECLA_ARRIBA) estado.applyMove('U'); // ↑
+        else if (ch == TECLA_ABAJO) estado.applyMove('D'); // ↓
+        else if (ch == TECLA_IZQUIERDA) estado.applyMove('L'); // ←
+        else if (ch == TECLA_DERECHA) estado.applyMove('R'); // →
         else {
-            // tecla normal
-            if (ch == 'S' || ch == 's') {
+            // tecla normal (o fin de la entrada)
+            if (ch == 'S' || ch == 's' || ch < 0) {
                 cout << "S detectada. Saliendo al prompt de tamaño...\n";
                 this_thread::sleep_for(chrono::milliseconds(400));
                 return;
             }
         }
 
-        // comprobar si ya se resolvió (opcional)
-        bool solved = true;
-        for (int i = 0; i < n * n - 1; ++i) if (state[i] != i + 1) { solved = false; break; }
-        if (solved && state[n * n - 1] == 0) {
-            printBoard(state, n);
+        // comprobar si ya se resolvió (todas las fichas en su lugar = manhattan 0)
+        if (estado.manhattan() == 0) {
+            printBoard(estado.tablero(), n);
             cout << "¡Felicidades! Has resuelto el puzzle. Volviendo al prompt de tamaño...\n";
             this_thread::sleep_for(chrono::milliseconds(8000));
             return;
@@ -369,18 +3606,109 @@ void playMode(vector<int> state, int n) {
 
 /* ---------------------- Programa principal ---------------------- */
 
-int main() {
+int main(int argc, char** argv) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    // Modo servicio: "programa --servicio [hilos] [archivo_cache]" (ver MotorServicio)
+    if (argc > 1 && string(argv[1]) == "--servicio") {
+        int hilos = (argc > 2) ? atoi(argv[2]) : (int)thread::hardware_concurrency();
+        string archivoCache = (argc > 3) ? argv[3] : "";
+        MotorServicio motor(hilos, (size_t)256 << 20, 30, archivoCache);
+        motor.ejecutar(cin, cout);
+        return 0;
+    }
+
+    // Banco de pruebas: "programa --bench [n] [cantidad] [semilla] [segundos] [distancia]" (ver ejecutarBanco)
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        int n = (argc > 2) ? atoi(argv[2]) : 3;
+        int cantidad = (argc > 3) ? atoi(argv[3]) : 20;
+        uint64_t semilla = (argc > 4) ? strtoull(argv[4], nullptr, 10) : 1;
+        int segundos = (argc > 5) ? atoi(argv[5]) : 30;
+        int distancia = (argc > 6) ? atoi(argv[6]) : 0;
+        if (n < 2 || cantidad < 1 || distancia < 0) {
+            cerr << "Uso: --bench [n >= 2] [cantidad >= 1] [semilla] [segundos] [distancia >= 0]\n";
+            return 1;
+        }
+        return ejecutarBanco(n, cantidad, semilla, segundos, distancia);
+    }
+
+    // Peticiones para pruebas de carga: "programa --generar [n] [cantidad] [semilla] [distancia]"
+    // escribe líneas "<id> <n> <tablero>" listas para --servicio (ej: ... --generar 4 1000 7 | programa --servicio 4)
+    if (argc > 1 && string(argv[1]) == "--generar") {
+        int n = (argc > 2) ? atoi(argv[2]) : 3;
+        int cantidad = (argc > 3) ? atoi(argv[3]) : 100;
+        uint64_t semilla = (argc > 4) ? strtoull(argv[4], nullptr, 10) : 1;
+        int distancia = (argc > 5) ? atoi(argv[5]) : 0;
+        if (n < 2 || cantidad < 1 || distancia < 0) {
+            cerr << "Uso: --generar [n >= 2] [cantidad >= 1] [semilla] [distancia >= 0]\n";
+            return 1;
+        }
+        vector<vector<int>> tableros = tablerosDePrueba(n, cantidad, semilla, distancia);
+        for (size_t i = 0; i < tableros.size(); ++i) cout << i << ' ' << n << ' ' << boardToKey(tableros[i]) << '\n';
+        return 0;
+    }
+
+    // Microbenchmarks de las primitivas: "programa --micro [n] [semilla]" (ver ejecutarMicro)
+    if (argc > 1 && string(argv[1]) == "--micro") {
+        int n = (argc > 2) ? atoi(argv[2]) : 3;
+        uint64_t semilla = (argc > 3) ? strtoull(argv[3], nullptr, 10) : 1;
+        if (n < 2) {
+            cerr << "Uso: --micro [n >= 2] [semilla]\n";
+            return 1;
+        }
+        return ejecutarMicro(n, semilla);
+    }
+
+    // Trabajo largo reanudable: "programa --bfs <n> <tablero> [segundos] [archivo_punto] [MB]"
+    // (tablero separado por comas, como boardToKey). Si el archivo tiene un punto de control de
+    // ese tablero se sigue desde ahí; al vencer el tiempo se guarda otro y se sale con código 2.
+    // Si el tiempo vence en un tramo sin punto de control (IDA* después de agotar la memoria, o la
+    // cola de n > 4) se sale con código 3; 1 queda para tableros inválidos o sin solución.
+    if (argc > 3 && string(argv[1]) == "--bfs") {
+        int n = atoi(argv[2]);
+        string texto = argv[3];
+        replace(texto.begin(), texto.end(), ',', ' ');
+        stringstream ss(texto);
+        vector<int> board;
+        for (int v; ss >> v;) board.push_back(v);
+        int segundos = (argc > 4) ? atoi(argv[4]) : 30;
+        string rutaPunto = (argc > 5) ? argv[5] : "npuzzle_bfs.punto";
+        size_t megas = (argc > 6) ? (size_t)atoll(argv[6]) : 256;
+        if (n < 2 || !esPermutacion(board, n) || !isSolvable(board, n)) {
+            cerr << "Tablero invalido o sin solucion\n";
+            return 1;
+        }
+        auto inicio = chrono::steady_clock::now();
+        auto result = bfsSolve(board, n, megas << 20, segundos, true, nullptr, nullptr, rutaPunto);
+        if (result.first) {
+            cout << movimientosDesdeClaves(result.second, n) << "\n";
+            return 0;
+        }
+        if (filesystem::exists(rutaPunto)) {
+            cout << "TIEMPO AGOTADO: se puede seguir desde " << rutaPunto << "\n";
+            return 2;
+        }
+        // sin punto de control: se cortó el IDA* (o el BFS con cola, n > 4), que no se reanudan
+        if (chrono::steady_clock::now() - inicio >= chrono::seconds(segundos)) {
+            cout << "TIEMPO AGOTADO: sin punto de control (IDA* o n > 4), no se puede reanudar\n";
+            return 3;
+        }
+        cout << "SIN SOLUCION\n";
+        return 1;
+    }
+
+    CacheSoluciones cacheSesion; // soluciones de esta sesión (y de sus tableros espejo)
+
     while (true) {
-        system("cls");
+        limpiarPantalla();
         cout << "========================================\n";
         cout << "   SLIDING TILES - Puzzle deslizante\n";
         cout << "========================================\n\n";
         cout << "Ingrese el tamano del puzzle (n): (ej: 2 para 2x2, 3 para 3x3, 0 para salir): ";
         int n;
         if (!(cin >> n)) {
+            if (cin.eof()) break; // se terminó la entrada (por ejemplo, redirigida desde un archivo)
             cin.clear();
             string junk; getline(cin, junk);
             cout << "Entrada invalida. Intenta de nuevo.\n";
@@ -401,9 +3729,12 @@ int main() {
         cout << "Menu:\n";
         cout << "  1) Resolver con Busqueda en Anchura (BFS)  (usa cola FIFO)\n";
         cout << "  2) Jugar manualmente (flechas). Presiona 'S' para salir.\n";
-        cout << "Elige opcion (1 o 2): ";
+        cout << "  3) Resolver con BFS de frontera (guarda solo dos capas, menos memoria)\n";
+        cout << "  4) Resolver con BFS ordenando capas (duplicados por ordenamiento, sin tabla hash)\n";
+        cout << "Elige opcion (1, 2, 3 o 4): ";
         int opcion;
         if (!(cin >> opcion)) {
+            if (cin.eof()) break;
             cin.clear();
             string junk; getline(cin, junk);
             cout << "Entrada invalida. Volviendo al prompt de tamaño.\n";
@@ -420,7 +3751,7 @@ int main() {
             continue;
         }
 
-        if (opcion == 1) {
+        if (opcion == 1 || opcion == 3 || opcion == 4) {
             // Intentar resolver con BFS (solo si n <= 3)
             if (n > 3) {
                 cout << "\n\nAtencion: BFS solo se ejecuta para n = 2 o n = 3 (puzzles mayores son impracticables con BFS).\n";
@@ -439,17 +3770,36 @@ int main() {
 
                 cout << "\nSi deseas, puedes jugar manualmente (opcion 2) o probar otro algoritmo (A*).\n";
                 cout << "Presiona una tecla para volver al menu de tamanos...\n";
-                _getch();
+                leerTecla();
                 continue;
             }
 
-            cout << "\nIniciando BFS (cola FIFO). Esto puede tardar algunos segundos para 3x3...\n";
-            auto result = bfsSolve(board, n, 600000, 30); // limites: nodos, tiempo
+            pair<bool, vector<string>> result;
+            string movsCache;
+            if (cacheSesion.buscar(board, n, movsCache)) {
+                // ya resuelto (o su espejo) en esta sesión: reconstruir los tableros con los movimientos
+                cout << "\nTablero ya resuelto antes (cache). Reconstruyendo pasos...\n";
+                EstadoTablero e(board, n);
+                result.first = true;
+                result.second.push_back(boardToKey(board));
+                for (char m : movsCache) { e.applyMove(m); result.second.push_back(boardToKey(e.tablero())); }
+            }
+            else {
+                cout << "\nIniciando BFS (cola FIFO). Esto puede tardar algunos segundos para 3x3...\n";
+                bool agotado;
+                if (opcion == 3)
+                    result = bfsFronteraSolve(board, n, (size_t)256 << 20, 30); // solo dos capas en memoria
+                else if (opcion == 4)
+                    result = bfsOrdenadoSolve(board, n, (size_t)256 << 20, chrono::steady_clock::now() + chrono::seconds(30), agotado);
+                else
+                    result = bfsSolve(board, n, (size_t)256 << 20, 30); // limites: 256 MB, tiempo
+                if (result.first) cacheSesion.guardar(board, n, movimientosDesdeClaves(result.second, n));
+            }
             if (!result.first) {
                 cout << "BFS no encontro solucion dentro de los limites establecidos (o se produjo timeout).\n";
                 cout << "Intenta volver a generar tablero o usa n=2 para ver un ejemplo rapido.\n";
                 cout << "Presiona una tecla para continuar...\n";
-                _getch();
+                leerTecla();
                 continue;
             }
 
@@ -462,8 +3812,9 @@ int main() {
             for (size_t step = 0; step < pathKeys.size(); ++step) {
                 vector<int> st = keyToBoard(pathKeys[step]);
                 
+                string cuadro; // texto del paso + tablero, una sola escritura por paso
                 if (step == 0) {
-                    cout << "Estado inicial\n";
+                    cuadro = "Estado inicial\n";
                 }
                 else {
                     // determinar movimiento comparando st con prev
@@ -482,18 +3833,18 @@ int main() {
                     else if (rCur == rPrev && cCur == cPrev - 1) mv = "IZQUIERDA";
                     else if (rCur == rPrev && cCur == cPrev + 1) mv = "DERECHA";
                     else mv = "DESCONOCIDO";
-                    cout << "Paso " << step << " -> Mover hueco: " << mv << "\n";
+                    cuadro = "Paso " + to_string(step) + " -> Mover hueco: " + mv + "\n";
                     stepglobal = step;
                 }
-                printBoard(st, n);
+                escribirTerminal(cuadro + dibujarTablero(st, n));
                 // pequeña pausa para ver cada paso (ajusta ms si quieres más lento/rápido)
-                //Sleep(500); // 500 ms (Windows)
+                //this_thread::sleep_for(chrono::milliseconds(500));
             }
 
             cout << "Fin de la solucion  \n";
             cout << "Se hicieron :  "<< stepglobal <<" pasos, para llegar a la solucion \n\n";
             cout << "Presiona una tecla para volver al prompt de tamanos...  \n";
-            _getch();
+            leerTecla();
             continue;
         }
 
@@ -10,10 +10,25 @@
 #include <unordered_map>
 #include <chrono>
 #include <algorithm>
+#include <optional>
 #include <sstream>
-#include <iostream>
-#include <vector>
-#include <string>
+#include <random>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <functional>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>  // MoveFileExA
+#include <io.h>       // _commit
+#else
+#include <unistd.h>   // fsync
+#endif
 using namespace std;
 
 // Función para crear el tablero dinámico
@@ -67,19 +82,28 @@ void crearTableroDesdeVector(int n, float startX, float startY,
     }
 }
 
-bool isSolvable(const std::vector<int>& board, int n)
+// Paridad de las inversiones en O(N): las fichas (sin el hueco) forman una
+// permutación y su paridad es (fichas - ciclos) % 2. Devuelve 0 (par) o 1 (impar).
+int paridadInversiones(const std::vector<int>& board)
 {
-    int inversions = 0;
-    for (size_t i = 0; i < board.size(); ++i)
+    std::vector<int> perm;
+    for (int v : board)
+        if (v != 0) perm.push_back(v - 1);
+
+    std::vector<char> visto(perm.size(), 0);
+    int ciclos = 0;
+    for (size_t i = 0; i < perm.size(); ++i)
     {
-        if (board[i] == 0) continue;
-        for (size_t j = i + 1; j < board.size(); ++j)
-        {
-            if (board[j] == 0) continue;
-            if (board[i] > board[j])
-                ++inversions;
-        }
+        if (visto[i]) continue;
+        ++ciclos;
+        for (size_t j = i; !visto[j]; j = perm[j]) visto[j] = 1;
     }
+    return ((int)perm.size() - ciclos) % 2;
+}
+
+bool isSolvable(const std::vector<int>& board, int n)
+{
+    int inversions = paridadInversiones(board); // solo importa la paridad
 
     if (n % 2 == 1)
     {
@@ -101,6 +125,14 @@ bool isSolvable(const std::vector<int>& board, int n)
 
 
 
+// Generador compartido (std::random_shuffle está obsoleto): se siembra una sola vez con
+// random_device, la primera vez que se usa.
+std::mt19937_64& generadorAleatorio()
+{
+    static std::mt19937_64 rng(std::random_device{}());
+    return rng;
+}
+
 std::vector<int> generarDisposicionAleatoria(int n)
 {
     std::vector<int> numeros;
@@ -108,10 +140,22 @@ std::vector<int> generarDisposicionAleatoria(int n)
         numeros.push_back(i);
 
     numeros.push_back(0); // Espacio vacío
+    const std::vector<int> objetivo = numeros;
 
-    do {
-        std::random_shuffle(numeros.begin(), numeros.end());
-    } while (!isSolvable(numeros, n)); // Repetir hasta que sea solvable
+    // Se vuelve a barajar si sale el tablero ya ordenado ("Orden aleatorio" nunca lo devuelve)
+    do
+    {
+        std::shuffle(numeros.begin(), numeros.end(), generadorAleatorio());
+
+        // Si no es solvable, intercambiar dos fichas (no el hueco) invierte la paridad:
+        // queda solvable sin volver a barajar.
+        if (!isSolvable(numeros, n))
+        {
+            int a = (numeros[0] == 0) ? 1 : 0;
+            int b = (numeros[a + 1] == 0) ? a + 2 : a + 1;
+            std::swap(numeros[a], numeros[b]);
+        }
+    } while (numeros == objetivo);
 
     return numeros;
 }
@@ -128,102 +172,869 @@ std::string estadoTableroAString(const std::vector<int>& numeros)
     return estado;
 }
 
+/* ---------------------- Reproducción de la solución ---------------------- */
+
+/*
+  La solución se guarda como secuencia de movimientos del hueco ('U','D','L','R'),
+  no como un tablero por paso: en cada tic de la animación se aplica el siguiente
+  movimiento al tablero actual. Memoria O(n*n) sin importar el largo de la solución.
+*/
+struct ReproduccionSolucion {
+    std::string movimientos; // un char por paso
+    size_t siguiente = 0;    // índice del próximo movimiento a aplicar
+
+    bool terminada() const { return siguiente >= movimientos.size(); }
+};
+
+// Mueve el hueco una casilla en la dirección dada. Devuelve false si se sale del tablero.
+bool aplicarMovimiento(std::vector<int>& numeros, int n, char mov)
+{
+    int pos0 = std::find(numeros.begin(), numeros.end(), 0) - numeros.begin();
+    int fila = pos0 / n;
+    int col = pos0 % n;
+
+    if (mov == 'U') fila--;
+    else if (mov == 'D') fila++;
+    else if (mov == 'L') col--;
+    else if (mov == 'R') col++;
+    else return false;
+
+    if (fila < 0 || fila >= n || col < 0 || col >= n) return false;
+    std::swap(numeros[pos0], numeros[fila * n + col]);
+    return true;
+}
+
+const size_t CLOCK_CADA_NODOS = 4096;   // leer el reloj solo cada tantos nodos
+
+/* ---------------------- Autómata de poda de movimientos ---------------------- */
+
+/*
+  AutomataPoda: prohíbe secuencias de movimientos que solo repiten tableros ya alcanzables
+  por un camino más corto (o igual de largo y menor en el orden U < D < L < R).
+  Se construye una sola vez con un BFS corto sobre secuencias de movimientos del hueco en
+  un tablero grande, con el hueco en el centro para que los bordes no influyan:
+   - si una secuencia deja el mismo tablero que otra anterior que no se sale de sus mismas
+     filas/columnas, la secuencia se prohíbe;
+   - con las secuencias prohibidas se arma un autómata de Aho-Corasick.
+  Cada nodo de la búsqueda guarda un estado del autómata y cada movimiento es una consulta
+  a la tabla "transicion" (-1 = podar). Con longitud 2 es la poda de siempre (no deshacer
+  el último movimiento); con 8 también poda, por ejemplo, dar dos vueltas a un cuadrado
+  de 2x2, que equivale a una vuelta en sentido contrario.
+  Movimientos: 0 = U, 1 = D, 2 = L, 3 = R.
+*/
+struct AutomataPoda {
+    vector<array<int, 4>> transicion; // transicion[estado][mov] = siguiente estado o -1
+
+    explicit AutomataPoda(int longitudMaxima = 8) {
+        int L = longitudMaxima;
+        int W = 2 * L + 1; // tablero W x W, el hueco nunca llega al borde
+        int dr[4] = { -1, 1, 0, 0 };
+        int dc[4] = { 0, 0, -1, 1 };
+
+        struct Secuencia {
+            string movs;
+            vector<uint16_t> tablero;
+            int hueco;
+            int caja[4]; // fila mínima, fila máxima, columna mínima, columna máxima
+        };
+        auto contenida = [](const int* a, const int* b) { // caja a dentro de caja b
+            return a[0] >= b[0] && a[1] <= b[1] && a[2] >= b[2] && a[3] <= b[3];
+        };
+
+        Secuencia ini;
+        ini.tablero.resize(W * W);
+        for (int i = 0; i < W * W; ++i) ini.tablero[i] = (uint16_t)i;
+        ini.hueco = L * W + L;
+        ini.caja[0] = ini.caja[1] = ini.caja[2] = ini.caja[3] = L;
+
+        map<vector<uint16_t>, array<int, 4>> vistos; // tablero -> caja de la primera secuencia
+        vistos[ini.tablero] = { L, L, L, L };
+        set<string> prohibidas;
+
+        vector<Secuencia> capa{ ini };
+        for (int len = 1; len <= L; ++len) {
+            vector<Secuencia> siguiente;
+            for (auto& s : capa) {
+                for (int k = 0; k < 4; ++k) {
+                    string t = s.movs + (char)('0' + k);
+                    bool yaPodada = false; // algún sufijo ya está prohibido
+                    for (size_t i = 1; i + 1 < t.size() && !yaPodada; ++i)
+                        yaPodada = prohibidas.count(t.substr(i)) > 0;
+                    if (yaPodada) continue;
+
+                    Secuencia x = s;
+                    int nr = x.hueco / W + dr[k], nc = x.hueco % W + dc[k];
+                    int nh = nr * W + nc;
+                    swap(x.tablero[x.hueco], x.tablero[nh]);
+                    x.hueco = nh;
+                    x.movs = t;
+                    x.caja[0] = min(x.caja[0], nr); x.caja[1] = max(x.caja[1], nr);
+                    x.caja[2] = min(x.caja[2], nc); x.caja[3] = max(x.caja[3], nc);
+
+                    auto it = vistos.find(x.tablero);
+                    if (it == vistos.end()) {
+                        vistos[x.tablero] = { x.caja[0], x.caja[1], x.caja[2], x.caja[3] };
+                    }
+                    else if (contenida(it->second.data(), x.caja)) {
+                        prohibidas.insert(t); // repite un tablero por un camino que también cabe
+                        continue;
+                    }
+                    siguiente.push_back(move(x));
+                }
+            }
+            capa.swap(siguiente);
+        }
+
+        // trie de las secuencias prohibidas
+        vector<array<int, 4>> hijos(1, { -1, -1, -1, -1 });
+        vector<char> terminal(1, 0);
+        for (auto& t : prohibidas) {
+            int u = 0;
+            for (char ch : t) {
+                int k = ch - '0';
+                if (hijos[u][k] < 0) {
+                    hijos[u][k] = (int)hijos.size();
+                    hijos.push_back({ -1, -1, -1, -1 });
+                    terminal.push_back(0);
+                }
+                u = hijos[u][k];
+            }
+            terminal[u] = 1;
+        }
+
+        // enlaces de falla (Aho-Corasick) y tabla de transiciones completa
+        vector<int> falla(hijos.size(), 0);
+        transicion = hijos;
+        queue<int> q;
+        for (int k = 0; k < 4; ++k) {
+            if (hijos[0][k] >= 0) q.push(hijos[0][k]);
+            else transicion[0][k] = 0;
+        }
+        while (!q.empty()) {
+            int u = q.front(); q.pop();
+            terminal[u] |= terminal[falla[u]];
+            for (int k = 0; k < 4; ++k) {
+                int v = hijos[u][k];
+                if (v >= 0) { falla[v] = transicion[falla[u]][k]; q.push(v); }
+                else transicion[u][k] = transicion[falla[u]][k];
+            }
+        }
+        for (auto& fila : transicion)
+            for (int k = 0; k < 4; ++k)
+                if (terminal[fila[k]]) fila[k] = -1;
+    }
+};
+
+/* ---------------------- Búsqueda de perímetro (vecindario del objetivo) ---------------------- */
+
+// TablaPerimetro: todos los tableros a distancia <= profundidad del objetivo (n <= 4) con su
+// distancia exacta, en una tabla hash de direccionamiento abierto (claves empaquetadas de a
+// 4 bits + distancias en un arreglo paralelo). Se arma con un BFS por capas desde el objetivo.
+// La DLS se detiene al entrar en el perímetro (el resto del camino sale de la tabla) y poda
+// las ramas que ya no pueden entrar antes del límite de profundidad.
+const int PROFUNDIDAD_PERIMETRO = 14; // 4x4: ~62 mil tableros, ~1 MB
+
+// Prefetch de la línea de caché donde está p (no cambia el resultado, solo adelanta la lectura)
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(p) __builtin_prefetch(p)
+#elif defined(_MSC_VER)
+#include <xmmintrin.h>
+#define PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#else
+#define PREFETCH(p) ((void)0)
+#endif
+
+class TablaPerimetro {
+public:
+    TablaPerimetro(int n_, int profundidad_) : n(n_), d(profundidad_), claves(1024, 0), distancias(1024, 0) {
+        uint64_t objetivo = 0;
+        for (int i = 0; i < n * n - 1; ++i) objetivo |= (uint64_t)(i + 1) << (4 * i);
+        vector<uint64_t> capa{ objetivo };
+        insertar(objetivo, 0);
+        for (int prof = 1; prof <= d && !capa.empty(); ++prof) {
+            vector<uint64_t> siguiente;
+            for (uint64_t s : capa)
+                for (int k = 0; k < 4; ++k) {
+                    uint64_t hijo;
+                    if (mover(s, k, hijo) && insertar(hijo, (uint8_t)prof)) siguiente.push_back(hijo);
+                }
+            capa.swap(siguiente);
+        }
+    }
+
+    int profundidad() const { return d; }
+
+    size_t bytes() const { return claves.size() * (sizeof(uint64_t) + sizeof(uint8_t)); }
+
+    // casilla donde empieza el sondeo de la clave (para adelantarla con PREFETCH)
+    const uint64_t* direccion(uint64_t clave) const {
+        return &claves[mezclar(clave) & (claves.size() - 1)];
+    }
+
+    // distancia exacta al objetivo, o -1 si el tablero está fuera del perímetro
+    int distancia(uint64_t clave) const {
+        size_t mask = claves.size() - 1;
+        for (size_t i = mezclar(clave) & mask;; i = (i + 1) & mask) {
+            if (claves[i] == clave) return distancias[i];
+            if (claves[i] == 0) return -1;
+        }
+    }
+
+    // movimientos óptimos desde un tablero del perímetro hasta el objetivo
+    string caminoAlObjetivo(uint64_t s) const {
+        static const char mc[4] = { 'U','D','L','R' };
+        string movs;
+        for (int dist = distancia(s); dist > 0; --dist) {
+            for (int k = 0; k < 4; ++k) {
+                uint64_t hijo;
+                if (mover(s, k, hijo) && distancia(hijo) == dist - 1) { s = hijo; movs += mc[k]; break; }
+            }
+        }
+        return movs;
+    }
+
+private:
+    int n, d;
+    vector<uint64_t> claves;    // 0 = libre (ningún tablero empaquetado vale 0)
+    vector<uint8_t> distancias;
+    size_t ocupadas = 0;
+
+    static uint64_t mezclar(uint64_t x) { // splitmix64
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    bool mover(uint64_t s, int k, uint64_t& hijo) const {
+        static const int dr[4] = { -1, 1, 0, 0 };
+        static const int dc[4] = { 0, 0, -1, 1 };
+        int zero = 0;
+        while (((s >> (4 * zero)) & 0xF) != 0) ++zero;
+        int nr = zero / n + dr[k], nc = zero % n + dc[k];
+        if (nr < 0 || nr >= n || nc < 0 || nc >= n) return false;
+        int nz = nr * n + nc;
+        uint64_t v = (s >> (4 * nz)) & 0xF;
+        hijo = s ^ (v << (4 * nz)) ^ (v << (4 * zero));
+        return true;
+    }
+
+    // true si la clave no estaba
+    bool insertar(uint64_t clave, uint8_t dist) {
+        if ((ocupadas + 1) * 2 > claves.size()) crecer();
+        size_t mask = claves.size() - 1;
+        for (size_t i = mezclar(clave) & mask;; i = (i + 1) & mask) {
+            if (claves[i] == clave) return false;
+            if (claves[i] == 0) { claves[i] = clave; distancias[i] = dist; ++ocupadas; return true; }
+        }
+    }
+
+    void crecer() {
+        vector<uint64_t> viejasClaves(claves.size() * 2, 0);
+        vector<uint8_t> viejasDist(claves.size() * 2, 0);
+        viejasClaves.swap(claves);
+        viejasDist.swap(distancias);
+        ocupadas = 0;
+        for (size_t i = 0; i < viejasClaves.size(); ++i)
+            if (viejasClaves[i]) insertar(viejasClaves[i], viejasDist[i]);
+    }
+};
+
+/* ---------------------- Punto de control de la DLS ---------------------- */
+
+// Estado de una DLS cortada por tiempo: con el tablero, el límite y la rama del nodo donde se
+// cortó alcanza para reanudarla (la búsqueda vuelve a bajar por esa rama y sigue desde ahí,
+// porque los hijos se prueban siempre en el mismo orden U, D, L, R).
+// Se escribe entero en ruta + ".tmp", se fuerza a disco y recién entonces se renombra: quien
+// lo lea ve el punto anterior o el nuevo, nunca uno a medias.
+const int SEGUNDOS_ENTRE_PUNTOS = 60; // cada cuánto se guarda mientras la búsqueda avanza
+
+bool escribirAtomico(const string& ruta, const function<bool(FILE*)>& escribir) {
+    string tmp = ruta + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = escribir(f) && fflush(f) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(f)) == 0;
+#else
+    ok = ok && fsync(fileno(f)) == 0;
+#endif
+    ok = (fclose(f) == 0) && ok;
+#ifdef _WIN32
+    ok = ok && MoveFileExA(tmp.c_str(), ruta.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    ok = ok && rename(tmp.c_str(), ruta.c_str()) == 0;
+#endif
+    if (!ok) remove(tmp.c_str());
+    return ok;
+}
+
+struct PuntoControlDLS {
+    string ruta;
+    int n = 0;
+    vector<int> inicio;
+    size_t depthLimit = 0;
+    string rama;      // movimientos desde inicio hasta el nodo donde se cortó
+    size_t nodos = 0;
+
+    bool guardar() const {
+        ostringstream out;
+        out << "NPZD 1\n" << n << ' ' << depthLimit << ' ' << nodos << '\n';
+        for (int v : inicio) out << v << ' ';
+        out << '\n' << (rama.empty() ? "-" : rama) << '\n';
+        string texto = out.str();
+        return escribirAtomico(ruta, [&](FILE* f) { return fwrite(texto.data(), 1, texto.size(), f) == texto.size(); });
+    }
+
+    // true si el archivo es de este mismo tablero y límite (entonces carga rama y nodos)
+    bool cargar() {
+        ifstream in(ruta);
+        string magia, version, movs;
+        int nArchivo;
+        size_t limiteArchivo, nodosArchivo;
+        if (!(in >> magia >> version >> nArchivo >> limiteArchivo >> nodosArchivo)) return false;
+        if (magia != "NPZD" || version != "1" || nArchivo != n || limiteArchivo != depthLimit) return false;
+        for (int v : inicio) {
+            int leido;
+            if (!(in >> leido) || leido != v) return false;
+        }
+        if (!(in >> movs) || (movs != "-" && movs.find_first_not_of("UDLR") != string::npos)) return false;
+        rama = (movs == "-") ? string() : movs;
+        nodos = nodosArchivo;
+        return true;
+    }
+
+    void borrar() const {
+        error_code ec;
+        filesystem::remove(ruta, ec);
+    }
+};
+
+/* ---------------------- Tableros de tamaño fijo (plantillas sobre n) ---------------------- */
+
+// Board<N>: tablero N x N en un std::array, con el objetivo y los vecinos de cada casilla
+// en tablas constexpr. dlsSolve usa la instancia de 2..8 que corresponde al n del cuadro
+// de texto y deja el vector<int> dinámico para tamaños mayores.
+const int N_FIJO_MAXIMO = 8;
+
+template <int N>
+constexpr array<uint8_t, N * N> tablaObjetivo() {
+    array<uint8_t, N * N> t{};
+    for (int i = 0; i < N * N - 1; ++i) t[i] = (uint8_t)(i + 1);
+    t[N * N - 1] = 0;
+    return t;
+}
+
+// vecinos[pos][k] = casilla a la que pasa el hueco con el movimiento k (U, D, L, R), -1 = fuera
+template <int N>
+constexpr array<array<int8_t, 4>, N * N> tablaVecinos() {
+    array<array<int8_t, 4>, N * N> t{};
+    for (int p = 0; p < N * N; ++p) {
+        int r = p / N, c = p % N;
+        t[p][0] = (int8_t)(r > 0 ? p - N : -1);
+        t[p][1] = (int8_t)(r < N - 1 ? p + N : -1);
+        t[p][2] = (int8_t)(c > 0 ? p - 1 : -1);
+        t[p][3] = (int8_t)(c < N - 1 ? p + 1 : -1);
+    }
+    return t;
+}
+
+template <int N> constexpr array<uint8_t, N * N> OBJETIVO_FIJO = tablaObjetivo<N>();
+template <int N> constexpr array<array<int8_t, 4>, N * N> VECINOS_FIJO = tablaVecinos<N>();
+
+template <int N>
+struct Board {
+    static constexpr int CELDAS = N * N;
+    array<uint8_t, CELDAS> celdas;
+    int hueco;
+    uint64_t clave; // empaquetado de a 4 bits (solo N <= 4), para TablaPerimetro
+
+    static Board desdeVector(const vector<int>& b) {
+        Board t;
+        t.clave = 0;
+        for (int i = 0; i < CELDAS; ++i) {
+            t.celdas[i] = (uint8_t)b[i];
+            if (b[i] == 0) t.hueco = i;
+            if constexpr (N <= 4) t.clave |= (uint64_t)b[i] << (4 * i);
+        }
+        return t;
+    }
+
+    bool esObjetivo() const { return celdas == OBJETIVO_FIJO<N>; }
+
+    // mueve el hueco con el movimiento k; false si se sale del tablero
+    bool mover(int k) {
+        int nz = VECINOS_FIJO<N>[hueco][k];
+        if (nz < 0) return false;
+        if constexpr (N <= 4) clave ^= ((uint64_t)celdas[nz] << (4 * nz)) ^ ((uint64_t)celdas[nz] << (4 * hueco));
+        celdas[hueco] = celdas[nz];
+        celdas[nz] = 0;
+        hueco = nz;
+        return true;
+    }
+};
+
+/* ---------------------- Búsqueda por pedazos ---------------------- */
+
+// Una búsqueda que se avanza de a "presupuesto" nodos y se puede seguir después exactamente
+// donde quedó. dlsSolve la avanza de a CLOCK_CADA_NODOS mirando el reloj entre pedazos; la
+// ventana la avanza NODOS_POR_CUADRO por cuadro en el mismo hilo, sin sincronizar nada.
+enum ResultadoPaso { PASO_EN_CURSO, PASO_ENCONTRADO, PASO_SIN_SOLUCION };
+
+const size_t NODOS_POR_CUADRO = 50000; // pocos ms de búsqueda entre dos cuadros
+
+struct BusquedaPorCuadros {
+    size_t nodes = 0; // nodos evaluados (se guarda en el punto de control)
+
+    virtual ~BusquedaPorCuadros() {}
+    virtual ResultadoPaso avanzar(size_t presupuesto) = 0;
+    virtual const string& ramaActual() const = 0; // rama que se está explorando (o la solución)
+    virtual void reanudar(const string& movs) = 0; // volver a bajar por una rama de PuntoControlDLS
+};
+
+// la tabla de perímetro del tamaño N (se construye la primera vez), nullptr si N > 4
+template <int N>
+const TablaPerimetro* perimetroFijo() {
+    if constexpr (N <= 4) {
+        static const TablaPerimetro tabla(N, PROFUNDIDAD_PERIMETRO);
+        return &tabla;
+    }
+    else {
+        return nullptr;
+    }
+}
+
+// DLS sobre Board<N>: misma búsqueda y misma poda que dlsSolveDinamico, pero con la recursión
+// en una pila explícita (un marco por nivel) para poder cortarla entre dos nodos
+template <int N>
+class DlsFijo final : public BusquedaPorCuadros {
+public:
+    DlsFijo(const vector<int>& start, size_t depthLimit_, const AutomataPoda& automata_,
+            const TablaPerimetro* perimetro_)
+        : cur(Board<N>::desdeVector(start)), depthLimit(depthLimit_), automata(automata_), perimetro(perimetro_)
+    {
+        pila.resize(depthLimit + 1);
+        pila[0] = { 0, 0, -1 };
+        rama.reserve(depthLimit + 1);
+    }
+
+    // Vuelve a bajar por una rama guardada (punto de control): en cada nivel se sigue después
+    // por el hijo siguiente al de la rama, y el último nodo se evalúa de nuevo.
+    void reanudar(const string& movs) override {
+        for (char c : movs) {
+            int k = int(find(MC, MC + 4, c) - MC);
+            if (k == 4) return;
+            int sigAut = automata.transicion[pila[tope].estadoAut][k];
+            if (tope == depthLimit || sigAut < 0 || !cur.mover(k)) return; // rama inválida: se sigue desde aquí
+            pila[tope].k = k + 1;
+            rama.push_back(c);
+            pila[++tope] = { sigAut, 0, k };
+        }
+    }
+
+    ResultadoPaso avanzar(size_t presupuesto) override {
+        while (estado == PASO_EN_CURSO) {
+            if (entrando) { // nodo recién alcanzado: se corta siempre antes de evaluarlo
+                if (presupuesto == 0) break;
+                --presupuesto;
+                ++nodes;
+                entrando = false;
+                if (!evaluar()) continue;
+            }
+
+            // bajar al próximo hijo del nodo de arriba (orden U, D, L, R)
+            Marco& m = pila[tope];
+            const int* transiciones = automata.transicion[m.estadoAut].data();
+            int k = m.k;
+            while (k < 4 && (transiciones[k] < 0 || !cur.mover(k))) ++k;
+            if (k == 4) { retroceder(); continue; }
+            m.k = k + 1;
+            rama.push_back(MC[k]);
+            pila[++tope] = { transiciones[k], 0, k };
+            entrando = true;
+        }
+        return estado;
+    }
+
+    const string& ramaActual() const override { return rama; }
+
+    // lo primero que va a leer el próximo avanzar: la casilla del perímetro del nodo de arriba
+    // (nullptr si no hay perímetro o la búsqueda terminó)
+    const void* proximaConsulta() const {
+        if (!perimetro || estado != PASO_EN_CURSO || !entrando) return nullptr;
+        return perimetro->direccion(cur.clave);
+    }
+
+private:
+    struct Marco {
+        int estadoAut;  // estado de AutomataPoda al llegar a este nodo
+        int k;          // próximo hijo a probar
+        int movLlegada; // movimiento que llevó a este nodo (-1 en la raíz)
+    };
+    static constexpr char MC[4] = { 'U','D','L','R' };
+
+    Board<N> cur;
+    string rama;
+    vector<Marco> pila; // pila[0..tope]: un marco por nivel de la rama actual
+    size_t tope = 0;
+    bool entrando = true;
+    ResultadoPaso estado = PASO_EN_CURSO;
+    size_t depthLimit;
+    const AutomataPoda& automata;
+    const TablaPerimetro* perimetro; // nullptr = bajar hasta el objetivo
+
+    // false si el nodo de arriba no se expande (ya se retrocedió o se terminó)
+    bool evaluar() {
+        size_t depth = tope;
+        if (perimetro) {
+            int exacta = perimetro->distancia(cur.clave);
+            if (exacta >= 0) { // dentro del perímetro: se llega si alcanza la profundidad que queda
+                if (depth + exacta > depthLimit) { retroceder(); return false; }
+                rama += perimetro->caminoAlObjetivo(cur.clave);
+                estado = PASO_ENCONTRADO;
+                return false;
+            }
+            // afuera faltan al menos profundidad + 1 movimientos
+            if (depth + perimetro->profundidad() + 1 > depthLimit) { retroceder(); return false; }
+        }
+        if (cur.esObjetivo()) { estado = PASO_ENCONTRADO; return false; }
+        if (depth >= depthLimit) { retroceder(); return false; }
+        return true;
+    }
+
+    void retroceder() {
+        int llegada = pila[tope].movLlegada;
+        if (tope == 0) { estado = PASO_SIN_SOLUCION; return; } // se salió de la raíz: no hay más ramas
+        --tope;
+        cur.mover(llegada ^ 1); // deshacer: el movimiento inverso es k ^ 1
+        rama.pop_back();
+    }
+};
+
+template <int N>
+pair<bool, string> dlsSolveFijo(const vector<int>& start, size_t depthLimit, int timeLimitSeconds,
+                                const AutomataPoda& automata, PuntoControlDLS* punto)
+{
+    DlsFijo<N> busqueda(start, depthLimit, automata, perimetroFijo<N>());
+    if (punto && punto->cargar()) {
+        busqueda.reanudar(punto->rama);
+        busqueda.nodes = punto->nodos;
+    }
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(timeLimitSeconds);
+    auto ultimoPunto = chrono::steady_clock::now();
+    ResultadoPaso r;
+    while ((r = busqueda.avanzar(CLOCK_CADA_NODOS)) == PASO_EN_CURSO) {
+        auto ahora = chrono::steady_clock::now();
+        bool agotado = ahora > deadline;
+        if (punto && (agotado || ahora - ultimoPunto > chrono::seconds(SEGUNDOS_ENTRE_PUNTOS))) {
+            // el nodo de arriba todavía no se evaluó: al reanudar se vuelve a entrar por él
+            punto->rama = busqueda.ramaActual();
+            punto->nodos = busqueda.nodes;
+            punto->guardar();
+            ultimoPunto = chrono::steady_clock::now();
+        }
+        if (agotado) return { false, string() };
+    }
+    if (punto) punto->borrar(); // terminó: ya no hay nada que reanudar
+    if (r != PASO_ENCONTRADO) return { false, string() };
+    return { true, busqueda.ramaActual() };
+}
+
 /* ---------------------- BFS (cola FIFO) que devuelve la secuencia de estados ---------------------- */
 
-pair<bool, vector<string>> dlsSolve(const vector<int>& start, int n, size_t depthLimit = 20, int timeLimitSeconds = 30) 
+// Devuelve la secuencia de movimientos del hueco ('U','D','L','R') desde start hasta el objetivo.
+// Memoria O(profundidad): los ciclos y caminos redundantes se podan con AutomataPoda
+// (una consulta de tabla por movimiento) en vez de guardar la rama en un unordered_set.
+pair<bool, string> dlsSolveDinamico(const vector<int>& start, int n, size_t depthLimit, int timeLimitSeconds)
 {
-    vector<string> emptyRes;
+    string emptyRes;
     int N = n * n;
     vector<int> goalVec(N);
     for (int i = 0; i < N - 1; ++i) goalVec[i] = i + 1;
     goalVec[N - 1] = 0;
 
-    string goalKey = estadoTableroAString(goalVec);
-    string startKey = estadoTableroAString(start);
-    if (startKey == goalKey) return { true, vector<string>{startKey} };
+    if (start == goalVec) return { true, string() };
 
     int dr[4] = { -1, 1, 0, 0 }; // filas: arriba, abajo, izq, der
     int dc[4] = { 0, 0, -1, 1 };
+    char mc[4] = { 'U','D','L','R' };
 
-    unordered_map<string, string> parent; // para reconstruir la ruta
-    parent[startKey] = ""; 
+    static const AutomataPoda automata(8); // se construye en la primera llamada
 
-    // conjunto de nodos en la rama actual para evitar ciclos (backtracking)
-    unordered_set<string> inPath;
-    inPath.insert(startKey);
+    // movimientos de la rama actual: al encontrar el objetivo es directamente la solución
+    string rama;
 
-    auto t0 = chrono::steady_clock::now();
+    size_t nodes = 0;
+    bool agotado = false; // timeout
 
-    function<bool(const vector<int>&, int)> dfs = [&](const vector<int>& cur, int depth) -> bool {
-        // time check
-        auto now = chrono::steady_clock::now();
-        auto elapsed = chrono::duration_cast<chrono::seconds>(now - t0).count();
-        if (elapsed > timeLimitSeconds) return false;
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(timeLimitSeconds);
 
-        string curKey = estadoTableroAString(cur);
-        if (curKey == goalKey) return true;
+    vector<int> cur = start; // se modifica en el lugar y se deshace al volver
+    int zero0 = int(find(cur.begin(), cur.end(), 0) - cur.begin());
+
+    function<bool(int, size_t, int)> dfs = [&](int zero, size_t depth, int estadoAut) -> bool {
+        // time check (amortizado)
+        if (agotado) return false;
+        if (++nodes % CLOCK_CADA_NODOS == 0 && chrono::steady_clock::now() > deadline) agotado = true;
+        if (agotado) return false;
+
+        if (cur == goalVec) return true;
         if (depth >= depthLimit) return false;
 
-        // encontrar hueco
-        int zero = -1;
-        for (int i = 0; i < N; ++i) if (cur[i] == 0) { zero = i; break; }
         int zr = zero / n;
         int zc = zero % n;
 
         // expandir hijos (orden: Up, Down, Left, Right)
         for (int k = 0; k < 4; ++k) {
+            int sigAut = automata.transicion[estadoAut][k];
+            if (sigAut < 0) continue; // secuencia redundante: ya se cubre por otro camino
+
             int nr = zr + dr[k];
             int nc = zc + dc[k];
             if (nr < 0 || nr >= n || nc < 0 || nc >= n) continue;
 
-            vector<int> nxt = cur;
             int swapIdx = nr * n + nc;
-            swap(nxt[zero], nxt[swapIdx]);
-            string nxtKey = estadoTableroAString(nxt);
-
-            // evitar ciclo en la rama actual
-            if (inPath.find(nxtKey) != inPath.end()) continue;
-
-            parent[nxtKey] = curKey;
-            inPath.insert(nxtKey);
+            swap(cur[zero], cur[swapIdx]);
+            rama.push_back(mc[k]);
 
-            if (dfs(nxt, depth + 1)) return true;
+            if (dfs(swapIdx, depth + 1, sigAut)) return true;
 
             // backtrack
-            inPath.erase(nxtKey);
+            swap(cur[zero], cur[swapIdx]);
+            rama.pop_back();
         }
         return false;
     };
 
-    if (!dfs(start, 0)) return { false, emptyRes };
+    if (!dfs(zero0, 0, 0)) return { false, emptyRes };
+    return { true, rama };
 
-    // reconstruir camino desde goalKey hacia startKey
-    vector<string> path;
-    string cur = goalKey;
-    while (!cur.empty()) {
-        path.push_back(cur);
-        cur = parent[cur];
+}
+
+// elige una sola vez la instancia de tamaño fijo según el n del tablero
+// rutaPunto: si no está vacía, al vencer el tiempo (y cada SEGUNDOS_ENTRE_PUNTOS) se guarda el
+// avance ahí, y una llamada posterior con el mismo tablero y límite sigue desde ese punto (n <= 8)
+pair<bool, string> dlsSolve(const vector<int>& start, int n, size_t depthLimit = 20, int timeLimitSeconds = 30,
+                            const string& rutaPunto = "")
+{
+    static const AutomataPoda automata(8);
+    PuntoControlDLS datosPunto;
+    datosPunto.ruta = rutaPunto;
+    datosPunto.n = n;
+    datosPunto.inicio = start;
+    datosPunto.depthLimit = depthLimit;
+    PuntoControlDLS* punto = rutaPunto.empty() ? nullptr : &datosPunto;
+    switch (n) {
+    case 2: return dlsSolveFijo<2>(start, depthLimit, timeLimitSeconds, automata, punto);
+    case 3: return dlsSolveFijo<3>(start, depthLimit, timeLimitSeconds, automata, punto);
+    case 4: return dlsSolveFijo<4>(start, depthLimit, timeLimitSeconds, automata, punto);
+    case 5: return dlsSolveFijo<5>(start, depthLimit, timeLimitSeconds, automata, punto);
+    case 6: return dlsSolveFijo<6>(start, depthLimit, timeLimitSeconds, automata, punto);
+    case 7: return dlsSolveFijo<7>(start, depthLimit, timeLimitSeconds, automata, punto);
+    case 8: return dlsSolveFijo<8>(start, depthLimit, timeLimitSeconds, automata, punto);
+    default: return dlsSolveDinamico(start, n, depthLimit, timeLimitSeconds);
     }
-    reverse(path.begin(), path.end());
-    return { true, path };
+}
 
+// la misma DLS para avanzarla de a pedazos desde la ventana; nullptr si n > 8
+unique_ptr<BusquedaPorCuadros> crearBusquedaPorCuadros(const vector<int>& start, int n, size_t depthLimit)
+{
+    static const AutomataPoda automata(8);
+    switch (n) {
+    case 2: return make_unique<DlsFijo<2>>(start, depthLimit, automata, perimetroFijo<2>());
+    case 3: return make_unique<DlsFijo<3>>(start, depthLimit, automata, perimetroFijo<3>());
+    case 4: return make_unique<DlsFijo<4>>(start, depthLimit, automata, perimetroFijo<4>());
+    case 5: return make_unique<DlsFijo<5>>(start, depthLimit, automata, perimetroFijo<5>());
+    case 6: return make_unique<DlsFijo<6>>(start, depthLimit, automata, perimetroFijo<6>());
+    case 7: return make_unique<DlsFijo<7>>(start, depthLimit, automata, perimetroFijo<7>());
+    case 8: return make_unique<DlsFijo<8>>(start, depthLimit, automata, perimetroFijo<8>());
+    default: return nullptr;
+    }
 }
 
+/* ---------------------- DLS en lote intercalada ---------------------- */
+
+/*
+  Para resolver muchos tableros seguidos en un solo núcleo. Una sola DLS se frena en cada
+  consulta a la tabla de perímetro que no está en caché (~1 MB en 4x4, acceso al azar).
+  dlsSolveLote mantiene "intercaladas" búsquedas abiertas y las avanza por turno de a un nodo:
+  después de cada paso pide con PREFETCH la casilla que esa búsqueda va a leer en su próximo
+  nodo y pasa a la siguiente, así las esperas a memoria de las distintas búsquedas se
+  superponen en vez de sumarse. Cuando una termina, su lugar lo toma el próximo tablero.
+  Cada tablero da el mismo resultado que dlsSolve con el mismo límite; el tiempo límite es
+  para todo el lote (los que no llegaron quedan en {false, ""}).
+  Cambiar de búsqueda en cada nodo tiene su costo (saltos peor predichos, estado fuera de
+  registros): con el perímetro de 14 niveles casi toda la tabla queda en caché y el lote
+  intercalado no gana, y con 16 niveles (~4.7 MB) tampoco; conviene cuando la tabla es
+  mucho más grande que la L2 (con 18 niveles, ~19 MB, 16 intercaladas ganan ~35% y sin
+  PREFETCH pierden mucho).
+  Por eso intercaladas = 0 (lo de siempre) elige solo: INTERCALADAS_LOTE si la tabla supera
+  TABLA_SOBRE_L2 veces la L2 y si no 1, que resuelve los tableros de a uno como dlsSolve.
+*/
+const int INTERCALADAS_LOTE = 16;
+const size_t TABLA_SOBRE_L2 = 8;
+
+// tamaño de la caché L2 (1 MB si el sistema no lo dice)
+size_t tamanoL2() {
+    long bytes = 0;
+#if defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+    bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return bytes > 0 ? (size_t)bytes : (size_t)1 << 20;
+}
 
+// cuántas búsquedas intercalar con esta tabla (1 = de a una)
+int intercaladasPara(const TablaPerimetro* perimetro) {
+    static const size_t l2 = tamanoL2();
+    return (perimetro && perimetro->bytes() > TABLA_SOBRE_L2 * l2) ? INTERCALADAS_LOTE : 1;
+}
 
+template <int N>
+vector<pair<bool, string>> dlsSolveLoteFijo(const vector<vector<int>>& tableros, size_t depthLimit,
+                                            int timeLimitSeconds, int intercaladas, const AutomataPoda& automata)
+{
+    vector<pair<bool, string>> res(tableros.size(), { false, string() });
+    const TablaPerimetro* perimetro = perimetroFijo<N>();
+    if (intercaladas <= 0 || !perimetro) intercaladas = intercaladasPara(perimetro); // N > 4: sin tabla, de a una
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(timeLimitSeconds);
+
+    if (intercaladas == 1) { // de a un tablero, con el mismo bucle que dlsSolve
+        for (size_t i = 0; i < tableros.size(); ++i) {
+            DlsFijo<N> busqueda(tableros[i], depthLimit, automata, perimetro);
+            ResultadoPaso r;
+            while ((r = busqueda.avanzar(CLOCK_CADA_NODOS)) == PASO_EN_CURSO)
+                if (chrono::steady_clock::now() > deadline) return res;
+            if (r == PASO_ENCONTRADO) res[i] = { true, busqueda.ramaActual() };
+        }
+        return res;
+    }
 
+    struct Ranura {
+        unique_ptr<DlsFijo<N>> busqueda;
+        size_t indice; // tablero que está resolviendo
+    };
+    vector<Ranura> ranuras;
+    size_t siguiente = 0;
+    auto abrir = [&](Ranura& r) { // false si ya no quedan tableros
+        if (siguiente == tableros.size()) { r.busqueda.reset(); return false; }
+        r.indice = siguiente;
+        r.busqueda = make_unique<DlsFijo<N>>(tableros[siguiente++], depthLimit, automata, perimetro);
+        return true;
+    };
+    for (int i = 0; i < intercaladas && siguiente < tableros.size(); ++i) {
+        ranuras.push_back({ nullptr, 0 });
+        abrir(ranuras.back());
+    }
+
+    size_t nodos = 0;
+    while (!ranuras.empty()) {
+        for (size_t i = 0; i < ranuras.size();) {
+            Ranura& r = ranuras[i];
+            ResultadoPaso paso = r.busqueda->avanzar(1);
+            if (paso == PASO_EN_CURSO) {
+                if (const void* p = r.busqueda->proximaConsulta()) PREFETCH(p);
+                ++i;
+                continue;
+            }
+            if (paso == PASO_ENCONTRADO) res[r.indice] = { true, r.busqueda->ramaActual() };
+            if (!abrir(r)) { // sin más tableros: la ranura se cierra
+                ranuras[i] = move(ranuras.back());
+                ranuras.pop_back();
+            }
+        }
+        nodos += ranuras.size();
+        if (nodos >= CLOCK_CADA_NODOS) {
+            nodos = 0;
+            if (chrono::steady_clock::now() > deadline) break;
+        }
+    }
+    return res;
+}
 
+// todos los tableros son de n x n; para n > 8 se resuelven de a uno con dlsSolve
+// intercaladas: búsquedas abiertas a la vez (0 = según el tamaño de la tabla, ver intercaladasPara)
+vector<pair<bool, string>> dlsSolveLote(const vector<vector<int>>& tableros, int n, size_t depthLimit = 20,
+                                        int timeLimitSeconds = 30, int intercaladas = 0)
+{
+    static const AutomataPoda automata(8);
+    switch (n) {
+    case 2: return dlsSolveLoteFijo<2>(tableros, depthLimit, timeLimitSeconds, intercaladas, automata);
+    case 3: return dlsSolveLoteFijo<3>(tableros, depthLimit, timeLimitSeconds, intercaladas, automata);
+    case 4: return dlsSolveLoteFijo<4>(tableros, depthLimit, timeLimitSeconds, intercaladas, automata);
+    case 5: return dlsSolveLoteFijo<5>(tableros, depthLimit, timeLimitSeconds, intercaladas, automata);
+    case 6: return dlsSolveLoteFijo<6>(tableros, depthLimit, timeLimitSeconds, intercaladas, automata);
+    case 7: return dlsSolveLoteFijo<7>(tableros, depthLimit, timeLimitSeconds, intercaladas, automata);
+    case 8: return dlsSolveLoteFijo<8>(tableros, depthLimit, timeLimitSeconds, intercaladas, automata);
+    default: {
+        vector<pair<bool, string>> res;
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(timeLimitSeconds);
+        for (auto& b : tableros) {
+            int restantes = (int)chrono::duration_cast<chrono::seconds>(deadline - chrono::steady_clock::now()).count();
+            res.push_back(restantes > 0 ? dlsSolve(b, n, depthLimit, restantes) : pair<bool, string>{ false, string() });
+        }
+        return res;
+    }
+    }
+}
+
+/* ---------------------- Planificador de redibujo ---------------------- */
 
+// Decide cuándo hace falta dibujar un cuadro y cuánto puede dormir el bucle principal.
+// Se redibuja solo si algo cambió (evento, paso de la animación, reloj de TGUI), nunca a
+// más de un cuadro cada MS_POR_CUADRO, y sin cambios el hilo duerme en waitEvent en vez
+// de ocupar un núcleo. Con una búsqueda en curso se duerme a lo sumo hasta el próximo
+// cuadro: cada vuelta del bucle avanza un pedazo de la búsqueda.
+struct PlanificadorRedibujo {
+    static const int MS_POR_CUADRO = 16;       // tope de ~60 cuadros por segundo
+    static const int MS_POR_MOVIMIENTO = 300;  // un movimiento de la solución cada 300 ms
+    static const int MS_INACTIVO = 500;        // despertar de vez en cuando (cursor de TGUI)
 
+    bool pendiente = true; // hay que dibujar (el primer cuadro siempre)
+    sf::Clock relojCuadro;
+    sf::Clock relojAnimacion;
 
+    void marcar() { pendiente = true; }
+
+    bool tocaMovimiento() const { return relojAnimacion.getElapsedTime().asMilliseconds() >= MS_POR_MOVIMIENTO; }
+
+    // true si hay que dibujar ahora (y lo da por dibujado)
+    bool tocaDibujar() {
+        if (!pendiente || relojCuadro.getElapsedTime().asMilliseconds() < MS_POR_CUADRO) return false;
+        pendiente = false;
+        relojCuadro.restart();
+        return true;
+    }
+
+    // cuánto esperar en waitEvent: hasta el próximo cuadro, el próximo movimiento o MS_INACTIVO
+    sf::Time espera(bool animando, bool buscando) const {
+        int ms = MS_INACTIVO;
+        if (pendiente || buscando) ms = std::min(ms, MS_POR_CUADRO - (int)relojCuadro.getElapsedTime().asMilliseconds());
+        if (animando) ms = std::min(ms, MS_POR_MOVIMIENTO - (int)relojAnimacion.getElapsedTime().asMilliseconds());
+        return sf::milliseconds(std::max(ms, 1)); // 0 en waitEvent sería esperar para siempre
+    }
+};
 
 int main()
 {
 
     
-    std::vector<std::vector<int>> solucion;
-    size_t indiceSolucion = 0;
+    ReproduccionSolucion reproduccion; // movimientos pendientes de la solución
     bool animando = false;
+    PlanificadorRedibujo planificador;
+    std::unique_ptr<BusquedaPorCuadros> busqueda; // DLS en curso: avanza NODOS_POR_CUADRO por cuadro
+    std::vector<int> inicioBusqueda;              // tablero desde el que se busca
+    PuntoControlDLS punto;                        // avance de la búsqueda en disco
+    punto.ruta = "npuzzle_dls.punto";
+    sf::Clock relojPunto;                         // tiempo desde el último guardado
+
+    // guarda la rama de la búsqueda en curso; el nodo de arriba todavía no se evaluó, así que
+    // al reanudar se vuelve a entrar por él (como en dlsSolveFijo)
+    auto guardarAvance = [&]() {
+        if (!busqueda) return;
+        punto.rama = busqueda->ramaActual();
+        punto.nodos = busqueda->nodes;
+        punto.guardar();
+        relojPunto.restart();
+    };
 
     std::vector<int> numerosTablero; // Para guardar la disposición actual
     int nTablero = 0; // Tamaño actual del tablero
@@ -295,6 +1106,8 @@ int main()
 
     if (n < 2 || n > 10) return;
 
+    guardarAvance(); // el tablero cambió: se guarda el avance y se deja la búsqueda
+    busqueda.reset();
     nTablero = n;
     numerosTablero.clear();
     for (int i = 1; i < n * n; ++i)
@@ -308,6 +1121,8 @@ int main()
         if (nTablero == 0)
             return;
 
+        guardarAvance();
+        busqueda.reset();
         numerosTablero = generarDisposicionAleatoria(nTablero);
         crearTableroDesdeVector(nTablero, 100, 200, numerosTablero, tablero, etiquetas, gui);
 
@@ -324,6 +1139,8 @@ int main()
     if (nTablero == 0)
         return;
 
+    guardarAvance();
+    busqueda.reset();
     numerosTablero.clear();
     for (int i = 1; i < nTablero * nTablero; ++i)
         numerosTablero.push_back(i);
@@ -341,48 +1158,96 @@ int main()
 
     // elige un límite de profundidad (puedes pedirlo al usuario con un EditBox)
     int depthLimit = 20; // ajusta según quieras
+
+    // n <= 8: la búsqueda avanza de a pedazos en el bucle principal (la ventana sigue respondiendo)
+    guardarAvance(); // si había otra en curso
+    busqueda = crearBusquedaPorCuadros(numerosTablero, nTablero, depthLimit);
+    if (busqueda) {
+        inicioBusqueda = numerosTablero;
+        animando = false;
+        planificador.marcar();
+        // si se cortó antes (se cerró la ventana, se cambió el tablero) sigue desde el punto guardado
+        punto.n = nTablero;
+        punto.inicio = numerosTablero;
+        punto.depthLimit = depthLimit;
+        if (punto.cargar()) {
+            busqueda->reanudar(punto.rama);
+            busqueda->nodes = punto.nodos;
+            std::cout << "Continuando la búsqueda guardada (" << punto.nodos << " nodos)..." << std::endl;
+        }
+        else {
+            std::cout << "Buscando solución..." << std::endl;
+        }
+        relojPunto.restart();
+        return;
+    }
+
     auto result = dlsSolve(numerosTablero, nTablero, depthLimit, 10); // 10s timeout
     if (!result.first) {
         std::cout << "No se encontró solución dentro del límite de profundidad/tiempo." << std::endl;
         return;
     }
-    std::cout << "Solución encontrada en " << result.second.size() - 1 << " movimientos." << std::endl;
+    std::cout << "Solución encontrada en " << result.second.size() << " movimientos." << std::endl;
 
-    solucion.clear();
-    for (auto& key : result.second) {
-        std::vector<int> estado;
-        std::stringstream ss(key);
-        std::string token;
-        while (std::getline(ss, token, ',')) {
-            estado.push_back(std::stoi(token));
-        }
-        solucion.push_back(estado);
-    }
-    indiceSolucion = 0;
+    reproduccion.movimientos = result.second;
+    reproduccion.siguiente = 0;
     animando = true;
+    planificador.relojAnimacion.restart();
 });
 
     // Bucle principal
     
     while (window.isOpen())
     {
+        // dormir hasta el próximo evento, movimiento de la animación o cuadro pendiente
+        std::optional<sf::Event> primero = window.waitEvent(planificador.espera(animando, busqueda != nullptr));
+
+        // un pedazo de la búsqueda por vuelta; mientras tanto se muestra la rama que explora
+        if (busqueda) {
+            ResultadoPaso r = busqueda->avanzar(NODOS_POR_CUADRO);
+            std::vector<int> vista = inicioBusqueda;
+            if (r == PASO_EN_CURSO)
+                for (char m : busqueda->ramaActual()) aplicarMovimiento(vista, nTablero, m);
+            crearTableroDesdeVector(nTablero, 100, 200, vista, tablero, etiquetas, gui);
+            planificador.marcar();
+
+            if (r == PASO_ENCONTRADO) {
+                std::cout << "Solución encontrada en " << busqueda->ramaActual().size() << " movimientos." << std::endl;
+                reproduccion.movimientos = busqueda->ramaActual();
+                reproduccion.siguiente = 0;
+                animando = true;
+                planificador.relojAnimacion.restart();
+            }
+            else if (r == PASO_SIN_SOLUCION) {
+                std::cout << "No se encontró solución dentro del límite de profundidad." << std::endl;
+            }
+            if (r != PASO_EN_CURSO) {
+                punto.borrar(); // terminó: ya no hay nada que reanudar
+                busqueda.reset();
+            }
+            else if (relojPunto.getElapsedTime().asSeconds() >= SEGUNDOS_ENTRE_PUNTOS) {
+                guardarAvance();
+            }
+        }
 
-        static sf::Clock relojAnim;
-        if (animando && indiceSolucion < solucion.size()) {
-            if (relojAnim.getElapsedTime().asMilliseconds() > 300) {
-                numerosTablero = solucion[indiceSolucion];
+        if (animando && !reproduccion.terminada()) {
+            if (planificador.tocaMovimiento()) {
+                // aplicar solo el siguiente movimiento sobre el tablero actual
+                aplicarMovimiento(numerosTablero, nTablero, reproduccion.movimientos[reproduccion.siguiente]);
                 crearTableroDesdeVector(nTablero, 100, 200, numerosTablero, tablero, etiquetas, gui);
-                indiceSolucion++;
-                relojAnim.restart();
-            }
-            if (indiceSolucion >= solucion.size()) {
-                animando = false; // terminó la animación
+                reproduccion.siguiente++;
+                planificador.relojAnimacion.restart();
+                planificador.marcar();
             }
         }
+        if (animando && reproduccion.terminada()) {
+            animando = false; // terminó la animación
+        }
 
-        while (auto event = window.pollEvent())
+        // el evento que despertó al bucle y los que estén en cola
+        for (auto event = std::move(primero); event; event = window.pollEvent())
         {
-
+            planificador.marcar(); // cualquier evento puede cambiar la GUI (hover, texto, clic)
             gui.handleEvent(*event);
 
             if (event->is<sf::Event::Closed>())
@@ -396,6 +1261,11 @@ int main()
             // Si no hay tablero aún, ignorar
             if (nTablero == 0)
                 continue;
+            if (busqueda) { // mover una ficha cancela la búsqueda: se vuelve al tablero de partida
+                guardarAvance();
+                busqueda.reset();
+                crearTableroDesdeVector(nTablero, 100, 200, numerosTablero, tablero, etiquetas, gui);
+            }
 
             const auto& keyEvent = event->getIf<sf::Event::KeyPressed>();
             if (!keyEvent) continue;
@@ -432,6 +1302,10 @@ int main()
 
  
         }
+
+        if (gui.updateTime()) planificador.marcar(); // animaciones y cursor de TGUI
+        if (!planificador.tocaDibujar()) continue;
+
         window.clear(sf::Color(60, 60, 60));
 
 
@@ -445,6 +1319,7 @@ int main()
         gui.draw();
         window.display();
     }
+    guardarAvance(); // se cerró la ventana con una búsqueda a medias: sigue en el próximo Resolver
     return 0;
     
 }
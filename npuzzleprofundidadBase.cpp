@@ -1,6 +1,24 @@
 #include <iostream>
 #include <vector>
 #include <stack>
+#include <array>
+#include <map>
+#include <set>
+#include <queue>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <iomanip>
+#include <random>
+#ifdef __linux__
+#include <linux/perf_event.h> // contadores de hardware (--bench)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -12,12 +30,14 @@ public:
     vector<int> accion = {0,0};
     vector<int> posicion_hueco = {0,0};
     int profundidad = 0;
+    int estado_automata = 0; //Estado del AutomataPoda tras los movimientos que llevaron a este nodo
 
-    Nodo(vector<vector<int>> est, vector<int> acc, vector<int> pos, int prof) {
+    Nodo(vector<vector<int>> est, vector<int> acc, vector<int> pos, int prof, int aut = 0) {
         estado = est;
         accion = acc;
         posicion_hueco = pos;
         profundidad = prof;
+        estado_automata = aut;
     }
 };
 
@@ -44,10 +64,277 @@ public:
     }
 };
 
+/*
+  AutomataPoda: prohíbe secuencias de movimientos que solo repiten tableros ya alcanzables
+  por un camino más corto (o igual de largo y menor en el orden U < D < L < R).
+  Se construye una sola vez con un BFS corto sobre secuencias de movimientos del hueco en
+  un tablero grande, con el hueco en el centro para que los bordes no influyan:
+   - si una secuencia deja el mismo tablero que otra anterior que no se sale de sus mismas
+     filas/columnas, la secuencia se prohíbe;
+   - con las secuencias prohibidas se arma un autómata de Aho-Corasick.
+  Cada nodo de la búsqueda guarda un estado del autómata y cada movimiento es una consulta
+  a la tabla "transicion" (-1 = podar). Con longitud 2 es la poda de siempre (no deshacer
+  el último movimiento); con 8 también poda, por ejemplo, dar dos vueltas a un cuadrado
+  de 2x2, que equivale a una vuelta en sentido contrario.
+  Movimientos: 0 = U, 1 = D, 2 = L, 3 = R.
+*/
+struct AutomataPoda {
+    vector<array<int, 4>> transicion; // transicion[estado][mov] = siguiente estado o -1
+
+    explicit AutomataPoda(int longitudMaxima = 8) {
+        int L = longitudMaxima;
+        int W = 2 * L + 1; // tablero W x W, el hueco nunca llega al borde
+        int dr[4] = { -1, 1, 0, 0 };
+        int dc[4] = { 0, 0, -1, 1 };
+
+        struct Secuencia {
+            string movs;
+            vector<uint16_t> tablero;
+            int hueco;
+            int caja[4]; // fila mínima, fila máxima, columna mínima, columna máxima
+        };
+        auto contenida = [](const int* a, const int* b) { // caja a dentro de caja b
+            return a[0] >= b[0] && a[1] <= b[1] && a[2] >= b[2] && a[3] <= b[3];
+        };
+
+        Secuencia ini;
+        ini.tablero.resize(W * W);
+        for (int i = 0; i < W * W; ++i) ini.tablero[i] = (uint16_t)i;
+        ini.hueco = L * W + L;
+        ini.caja[0] = ini.caja[1] = ini.caja[2] = ini.caja[3] = L;
+
+        map<vector<uint16_t>, array<int, 4>> vistos; // tablero -> caja de la primera secuencia
+        vistos[ini.tablero] = { L, L, L, L };
+        set<string> prohibidas;
+
+        vector<Secuencia> capa{ ini };
+        for (int len = 1; len <= L; ++len) {
+            vector<Secuencia> siguiente;
+            for (auto& s : capa) {
+                for (int k = 0; k < 4; ++k) {
+                    string t = s.movs + (char)('0' + k);
+                    bool yaPodada = false; // algún sufijo ya está prohibido
+                    for (size_t i = 1; i + 1 < t.size() && !yaPodada; ++i)
+                        yaPodada = prohibidas.count(t.substr(i)) > 0;
+                    if (yaPodada) continue;
+
+                    Secuencia x = s;
+                    int nr = x.hueco / W + dr[k], nc = x.hueco % W + dc[k];
+                    int nh = nr * W + nc;
+                    swap(x.tablero[x.hueco], x.tablero[nh]);
+                    x.hueco = nh;
+                    x.movs = t;
+                    x.caja[0] = min(x.caja[0], nr); x.caja[1] = max(x.caja[1], nr);
+                    x.caja[2] = min(x.caja[2], nc); x.caja[3] = max(x.caja[3], nc);
+
+                    auto it = vistos.find(x.tablero);
+                    if (it == vistos.end()) {
+                        vistos[x.tablero] = { x.caja[0], x.caja[1], x.caja[2], x.caja[3] };
+                    }
+                    else if (contenida(it->second.data(), x.caja)) {
+                        prohibidas.insert(t); // repite un tablero por un camino que también cabe
+                        continue;
+                    }
+                    siguiente.push_back(move(x));
+                }
+            }
+            capa.swap(siguiente);
+        }
+
+        // trie de las secuencias prohibidas
+        vector<array<int, 4>> hijos(1, { -1, -1, -1, -1 });
+        vector<char> terminal(1, 0);
+        for (auto& t : prohibidas) {
+            int u = 0;
+            for (char ch : t) {
+                int k = ch - '0';
+                if (hijos[u][k] < 0) {
+                    hijos[u][k] = (int)hijos.size();
+                    hijos.push_back({ -1, -1, -1, -1 });
+                    terminal.push_back(0);
+                }
+                u = hijos[u][k];
+            }
+            terminal[u] = 1;
+        }
+
+        // enlaces de falla (Aho-Corasick) y tabla de transiciones completa
+        vector<int> falla(hijos.size(), 0);
+        transicion = hijos;
+        queue<int> q;
+        for (int k = 0; k < 4; ++k) {
+            if (hijos[0][k] >= 0) q.push(hijos[0][k]);
+            else transicion[0][k] = 0;
+        }
+        while (!q.empty()) {
+            int u = q.front(); q.pop();
+            terminal[u] |= terminal[falla[u]];
+            for (int k = 0; k < 4; ++k) {
+                int v = hijos[u][k];
+                if (v >= 0) { falla[v] = transicion[falla[u]][k]; q.push(v); }
+                else transicion[u][k] = transicion[falla[u]][k];
+            }
+        }
+        for (auto& fila : transicion)
+            for (int k = 0; k < 4; ++k)
+                if (terminal[fila[k]]) fila[k] = -1;
+    }
+};
+
+/*
+  Oraculo_Distancias: un solo BFS completo desde un estado ancla (inicio u objetivo) y después
+  cualquier cantidad de consultas contra ese ancla sin volver a buscar.
+   - Cada estado se indexa por el rango de su permutación (código de Lehmer), 0..(n*n)!-1.
+   - Por estado se guarda un byte: (distancia << 2) | accion con la que el BFS llegó a él
+     (0 = arriba, 1 = abajo, 2 = izquierda, 3 = derecha), 0xFF = no alcanzable desde el ancla.
+     En 3x3 son 362880 bytes.
+   - distancia(estado) es una consulta de tabla; el camino sale de seguir las acciones
+     guardadas hacia atrás hasta el ancla (cada paso es otra consulta).
+  Como los movimientos son reversibles, sirve igual si el ancla es el inicio o el objetivo.
+  Solo para n <= 3: en 4x4 la tabla tendría 16! entradas y el rango no entra en 32 bits.
+  Con otro tamaño el constructor no arma nada: valido() da false y toda consulta da -1 o vacío.
+*/
+class Oraculo_Distancias {
+public:
+    int n = 0;
+    vector<vector<int>> estado_ancla;
+
+    Oraculo_Distancias(vector<vector<int>> ancla, int tam) {
+        estado_ancla = ancla;
+        n = tam;
+        if (n < 2 || n > 3) return;
+        int N = n * n;
+        size_t total = 1;
+        for (int i = 2; i <= N; i++) total *= i;
+        tabla.assign(total, NO_ALCANZABLE);
+
+        vector<uint32_t> cola;
+        cola.reserve(total / 2);
+        uint32_t rango_ancla = rango(aplanar(ancla));
+        tabla[rango_ancla] = 0;
+        cola.push_back(rango_ancla);
+
+        //BFS por rangos: "cola" se recorre en orden y solo crece
+        for (size_t i = 0; i < cola.size(); i++) {
+            vector<int> estado = desde_rango(cola[i], N);
+            int distancia_actual = tabla[cola[i]] >> 2;
+            int hueco = 0;
+            while (estado[hueco] != 0) hueco++;
+
+            for (int k = 0; k < 4; k++) {
+                int fila = hueco / n + acciones[k][0];
+                int columna = hueco % n + acciones[k][1];
+                if (fila < 0 || fila >= n || columna < 0 || columna >= n) continue;
+
+                int hueco_nuevo = fila * n + columna;
+                swap(estado[hueco], estado[hueco_nuevo]);
+                uint32_t r = rango(estado);
+                if (tabla[r] == NO_ALCANZABLE) {
+                    tabla[r] = (uint8_t)(((distancia_actual + 1) << 2) | k);
+                    cola.push_back(r);
+                }
+                swap(estado[hueco], estado[hueco_nuevo]);
+            }
+        }
+    }
+
+    bool valido() {
+        return !tabla.empty();
+    }
+
+    //Cantidad minima de movimientos entre el ancla y el estado (-1 si no es alcanzable)
+    int distancia(vector<vector<int>> estado) {
+        if (!valido()) return -1;
+        uint8_t valor = tabla[rango(aplanar(estado))];
+        return valor == NO_ALCANZABLE ? -1 : valor >> 2;
+    }
+
+    //Acciones del hueco ({fila, columna} como en Nodo::accion) que llevan del estado al ancla
+    vector<vector<int>> acciones_hacia_ancla(vector<vector<int>> estado) {
+        vector<vector<int>> resultado;
+        if (!valido()) return resultado;
+        vector<int> actual = aplanar(estado);
+        uint8_t valor = tabla[rango(actual)];
+        if (valor == NO_ALCANZABLE) return resultado;
+
+        int hueco = 0;
+        while (actual[hueco] != 0) hueco++;
+        while (valor >> 2 > 0) {
+            int k = (valor & 3) ^ 1; //deshacer la accion con la que el BFS llegó aquí
+            int hueco_nuevo = (hueco / n + acciones[k][0]) * n + (hueco % n + acciones[k][1]);
+            swap(actual[hueco], actual[hueco_nuevo]);
+            hueco = hueco_nuevo;
+            resultado.push_back({ acciones[k][0], acciones[k][1] });
+            valor = tabla[rango(actual)];
+        }
+        return resultado;
+    }
+
+    //Acciones del hueco que llevan del ancla al estado (el camino anterior al revés)
+    vector<vector<int>> acciones_desde_ancla(vector<vector<int>> estado) {
+        vector<vector<int>> resultado = acciones_hacia_ancla(estado);
+        reverse(resultado.begin(), resultado.end());
+        for (size_t i = 0; i < resultado.size(); i++) {
+            resultado[i][0] = -resultado[i][0];
+            resultado[i][1] = -resultado[i][1];
+        }
+        return resultado;
+    }
+
+    size_t bytes() {
+        return tabla.size();
+    }
+
+private:
+    static constexpr uint8_t NO_ALCANZABLE = 0xFF;
+    //Mismo orden que el autómata: arriba, abajo, izquierda, derecha (el inverso de k es k ^ 1)
+    const int acciones[4][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+    vector<uint8_t> tabla;
+
+    vector<int> aplanar(const vector<vector<int>>& estado) {
+        vector<int> plano;
+        for (size_t i = 0; i < estado.size(); i++)
+            for (size_t j = 0; j < estado[i].size(); j++)
+                plano.push_back(estado[i][j]);
+        return plano;
+    }
+
+    //Rango de la permutación (código de Lehmer)
+    uint32_t rango(const vector<int>& estado) {
+        int N = estado.size();
+        uint32_t r = 0;
+        for (int i = 0; i < N; i++) {
+            int menores = 0;
+            for (int j = i + 1; j < N; j++)
+                if (estado[j] < estado[i]) menores++;
+            r = r * (N - i) + menores;
+        }
+        return r;
+    }
+
+    vector<int> desde_rango(uint32_t r, int N) {
+        vector<int> digitos(N);
+        for (int i = N - 1; i >= 0; i--) {
+            digitos[i] = r % (N - i);
+            r /= (N - i);
+        }
+        vector<int> libres;
+        for (int v = 0; v < N; v++) libres.push_back(v);
+        vector<int> estado(N);
+        for (int i = 0; i < N; i++) {
+            estado[i] = libres[digitos[i]];
+            libres.erase(libres.begin() + digitos[i]);
+        }
+        return estado;
+    }
+};
+
 void expandir_nodos(Nodo nodo_actual, stack<Nodo>& pila_por_revisar, int n)
 {
     //Se define como se puede mover el hueco en filas y columnas 
-    //Teniendo en cuenta que no se repitan movimientos, en caso de que se evalue la accion opuesta a la anterior se debe saltar esa iteración
+    //Teniendo en cuenta que no se repitan movimientos: el autómata de poda prohíbe deshacer la accion
+    //anterior y también otras secuencias que solo repiten estados (una consulta de tabla por accion)
+    static const AutomataPoda automata(8);
 
     vector<vector<int>> acciones_posibles = {
         {0, 1},    //derecha
@@ -56,9 +343,13 @@ void expandir_nodos(Nodo nodo_actual, stack<Nodo>& pila_por_revisar, int n)
         {-1, 0}  //arriba
     };
 
+    //Numero de cada accion en el autómata (0 = arriba, 1 = abajo, 2 = izquierda, 3 = derecha)
+    int movimiento_automata[4] = {3, 2, 1, 0};
+
     for (int i = 0; i < acciones_posibles.size(); i++) {
 
-        if(acciones_posibles[i][0] == -nodo_actual.accion[0] && acciones_posibles[i][1] == -nodo_actual.accion[1])
+        int siguiente_automata = automata.transicion[nodo_actual.estado_automata][movimiento_automata[i]];
+        if(siguiente_automata < 0)
             continue;
 
         vector<int> posicion_hueco_nuevo = {
@@ -77,7 +368,7 @@ void expandir_nodos(Nodo nodo_actual, stack<Nodo>& pila_por_revisar, int n)
             nuevo_estado[nodo_actual.posicion_hueco[0]][nodo_actual.posicion_hueco[1]] = auxiliar;
 
             //Se define el nuevo nodo a agregar a la pila
-            Nodo nuevo_nodo(nuevo_estado, acciones_posibles[i], posicion_hueco_nuevo, nodo_actual.profundidad + 1);
+            Nodo nuevo_nodo(nuevo_estado, acciones_posibles[i], posicion_hueco_nuevo, nodo_actual.profundidad + 1, siguiente_automata);
 
             pila_por_revisar.push(nuevo_nodo);
         }
@@ -140,8 +431,25 @@ void imprimirPila(stack<Nodo> pila) {
         pila.pop();
     }
 }
-int main()
+int main_busqueda_profundidad_limitada();
+int main_oraculo_distancias(int n);
+int main_banco(int cantidad, int pasos, unsigned semilla);
+
+//Sin argumentos: busqueda en profundidad limitada. Con "--oraculo [n]": consultas contra un solo BFS
+//(n = 2 o 3, por defecto 3). Con "--bench [cantidad] [pasos] [semilla]": tiempos y contadores de hardware de la busqueda
+int main(int argc, char** argv)
 {
+    if (argc > 1 && string(argv[1]) == "--oraculo") {
+        int n = argc > 2 ? atoi(argv[2]) : 3;
+        if (n < 2 || n > 3) {
+            cout << "El oraculo solo admite n = 2 o 3 (en 4x4 la tabla tendria 16! entradas)" << endl;
+            return 1;
+        }
+        return main_oraculo_distancias(n);
+    }
+    if (argc > 1 && string(argv[1]) == "--bench")
+        return main_banco(argc > 2 ? atoi(argv[2]) : 20, argc > 3 ? atoi(argv[3]) : 10,
+                          argc > 4 ? (unsigned)atoi(argv[4]) : 1);
     main_busqueda_profundidad_limitada();
 }
 
@@ -195,8 +503,215 @@ int main_busqueda_profundidad_limitada()
     }
 }
 
+int main_oraculo_distancias(int n)
+{
+    //Objetivo de siempre: 1..n*n-1 por filas y el hueco al final
+    vector<vector<int>> estado_objetivo(n, vector<int>(n));
+    for (int i = 0; i < n * n; i++)
+        estado_objetivo[i / n][i % n] = (i + 1) % (n * n);
+
+    //Un solo BFS desde el objetivo; después cada consulta es una lectura de tabla
+    Oraculo_Distancias oraculo(estado_objetivo, n);
+    cout << "Tabla del oraculo: " << oraculo.bytes() << " bytes" << endl;
+
+    //Consultas: estados iniciales leidos como n*n numeros por linea (fin con EOF)
+    vector<vector<int>> estado(n, vector<int>(n));
+    while (true) {
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                if (!(cin >> estado[i][j])) return 0;
+
+        int distancia = oraculo.distancia(estado);
+        if (distancia < 0) {
+            cout << "No se puede llegar al objetivo desde ese estado" << endl;
+            continue;
+        }
+        cout << "Distancia al objetivo: " << distancia << endl;
+        cout << "Acciones:";
+        vector<vector<int>> acciones = oraculo.acciones_hacia_ancla(estado);
+        for (size_t i = 0; i < acciones.size(); i++)
+            cout << " (" << acciones[i][0] << "," << acciones[i][1] << ")";
+        cout << endl;
+    }
+}
 
+/*
+  ContadoresHardware: ciclos, instrucciones, fallos de LLC, fallos de predicción de saltos y
+  fallos de dTLB de este hilo, leídos con perf_event_open (solo Linux). Cada contador se abre
+  por separado: si el kernel o la máquina no permiten alguno (perf_event_paranoid, máquina
+  virtual sin PMU, otro sistema operativo) ese queda en -1 y el resto se mide igual.
+  Si el kernel tuvo que turnar los contadores, el valor se escala por tiempo habilitado/corriendo.
+*/
+class ContadoresHardware {
+public:
+    enum { CICLOS, INSTRUCCIONES, FALLOS_LLC, FALLOS_SALTO, FALLOS_DTLB, CANTIDAD };
 
+    static const char* nombre(int i) {
+        static const char* nombres[CANTIDAD] = { "ciclos", "instrucciones", "fallos LLC", "fallos salto", "fallos dTLB" };
+        return nombres[i];
+    }
 
+    ContadoresHardware() {
+        fds.fill(-1);
+        valores.fill(-1);
+#ifdef __linux__
+        const uint64_t LECTURA_FALLO = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const uint32_t tipos[CANTIDAD] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                           PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+        const uint64_t configs[CANTIDAD] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                             PERF_COUNT_HW_CACHE_LL | LECTURA_FALLO, PERF_COUNT_HW_BRANCH_MISSES,
+                                             PERF_COUNT_HW_CACHE_DTLB | LECTURA_FALLO };
+        for (int i = 0; i < CANTIDAD; ++i) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = tipos[i];
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1; // solo el código del solve (y funciona con perf_event_paranoid = 2)
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0); // este hilo, cualquier CPU
+            if (fds[i] < 0 && i == FALLOS_LLC) { // sin el evento de caché LL: el genérico (casi siempre LLC)
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            }
+            if (fds[i] < 0 && motivo.empty()) motivo = strerror(errno);
+        }
+#else
+        motivo = "perf_event_open solo existe en Linux";
+#endif
+    }
+
+    ContadoresHardware(const ContadoresHardware&) = delete;
+    ContadoresHardware& operator=(const ContadoresHardware&) = delete;
 
+    ~ContadoresHardware() {
+#ifdef __linux__
+        for (int fd : fds) if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool disponible(int i) const { return fds[i] >= 0; }
+    const string& motivoFalla() const { return motivo; } // por qué no se abrió el primero que faltó
 
+    void iniciar() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void detener() {
+#ifdef __linux__
+        for (int i = 0; i < CANTIDAD; ++i) {
+            if (fds[i] < 0) continue;
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t lectura[3]; // valor, tiempo habilitado, tiempo corriendo
+            if (read(fds[i], lectura, sizeof(lectura)) != (ssize_t)sizeof(lectura) || lectura[2] == 0) {
+                valores[i] = -1;
+                continue;
+            }
+            valores[i] = (long long)((double)lectura[0] * lectura[1] / lectura[2]);
+        }
+#endif
+    }
+
+    long long valor(int i) const { return valores[i]; } // -1 = no disponible
+
+private:
+    array<int, CANTIDAD> fds;
+    array<long long, CANTIDAD> valores;
+    string motivo;
+};
+
+//Banco de pruebas: "cantidad" estados iniciales de 3x3 a "pasos" movimientos al azar del objetivo
+//(misma semilla, mismos estados), cada uno resuelto con busqueda_profundidad_limitada y limite
+//"pasos". Se muestran tiempo, nodos visitados, nodos/s y los contadores de hardware.
+//Los mensajes de la busqueda se descartan mientras se mide (escribirlos costaria mas que buscar).
+int main_banco(int cantidad, int pasos, unsigned semilla)
+{
+    int n = 3;
+    if (cantidad < 1 || pasos < 0) {
+        cerr << "Uso: --bench [cantidad >= 1] [pasos >= 0] [semilla]" << endl;
+        return 1;
+    }
+    vector<vector<int>> estado_objetivo = {
+        {1, 2, 3},
+        {4, 5, 6},
+        {7, 8, 0}
+    };
+
+    //Estados iniciales: caminatas al azar desde el objetivo
+    mt19937 rng(semilla);
+    vector<vector<vector<int>>> iniciales;
+    for (int c = 0; c < cantidad; c++) {
+        vector<vector<int>> estado = estado_objetivo;
+        int fila = n - 1, columna = n - 1;
+        for (int p = 0; p < pasos; p++) {
+            int movimientos[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            int k = rng() % 4;
+            int f = fila + movimientos[k][0], col = columna + movimientos[k][1];
+            if (f < 0 || f >= n || col < 0 || col >= n) { p--; continue; }
+            swap(estado[fila][columna], estado[f][col]);
+            fila = f;
+            columna = col;
+        }
+        iniciales.push_back(estado);
+    }
+
+    ContadoresHardware contadores;
+    if (!contadores.motivoFalla().empty())
+        cout << "Aviso: no se pudieron abrir todos los contadores de hardware (" << contadores.motivoFalla() << ")" << endl;
+
+    array<long long, ContadoresHardware::CANTIDAD> total;
+    total.fill(0);
+    size_t nodos = 0, resueltos = 0;
+    double tiempo = 0;
+    for (int c = -1; c < cantidad; c++) { //c = -1: calentamiento (autómata de poda), no se cuenta
+        const vector<vector<int>>& estado_inicial = iniciales[c < 0 ? 0 : c];
+        Rompecabezas_DLS rompecabezas(estado_inicial, estado_objetivo, n, pasos);
+        stack<Nodo> pila_visitados;
+        stack<Nodo> pila_por_revisar;
+        vector<int> posicion_hueco;
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                if (estado_inicial[i][j] == 0) posicion_hueco = {i, j};
+        pila_por_revisar.push(Nodo(estado_inicial, {0,0}, posicion_hueco, 0));
+
+        streambuf* salida = cout.rdbuf(nullptr);
+        auto t0 = chrono::steady_clock::now();
+        contadores.iniciar();
+        string resultado = busqueda_profundidad_limitada(rompecabezas, pila_por_revisar, pila_visitados);
+        contadores.detener();
+        double segundos = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        cout.rdbuf(salida);
+        cout.clear();
+        if (c < 0) continue;
+
+        tiempo += segundos;
+        nodos += pila_visitados.size();
+        resueltos += (resultado == "objetivo");
+        for (int i = 0; i < ContadoresHardware::CANTIDAD; i++)
+            if (total[i] >= 0) total[i] = contadores.valor(i) < 0 ? -1 : total[i] + contadores.valor(i);
+    }
+
+    cout << "busqueda_profundidad_limitada: " << resueltos << "/" << cantidad << " resueltos, "
+         << fixed << setprecision(3) << tiempo << " s, " << nodos << " nodos, "
+         << setprecision(0) << (tiempo > 0 ? nodos / tiempo : 0.0) << " nodos/s" << endl;
+    for (int i = 0; i < ContadoresHardware::CANTIDAD; i++) {
+        cout << "    " << left << setw(14) << ContadoresHardware::nombre(i) << right;
+        if (total[i] < 0) { cout << setw(16) << "n/d" << endl; continue; }
+        cout << setw(16) << total[i];
+        if (nodos > 0) cout << "   " << setprecision(2) << (double)total[i] / nodos << " por nodo";
+        cout << endl;
+    }
+    if (total[ContadoresHardware::CICLOS] > 0 && total[ContadoresHardware::INSTRUCCIONES] >= 0)
+        cout << "    IPC           " << setw(16) << setprecision(2)
+             << (double)total[ContadoresHardware::INSTRUCCIONES] / total[ContadoresHardware::CICLOS] << endl;
+    return 0;
+}